@@ -0,0 +1,124 @@
+#include "arena.h"
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ARENA_ALIGN 16
+#define ARENA_MIN_BLOCK (256 * 1024)
+
+/* a frame that outgrows the current block chains on another one instead of moving what's already handed out. the
+   next reset folds the chain back into a single block big enough for that frame, so steady state is one block and
+   one pointer bump per allocation */
+typedef struct ArenaBlock
+{
+    struct ArenaBlock *prev;
+    size_t size;
+    size_t used;
+    char *data;
+} ArenaBlock;
+
+static ArenaBlock *current = NULL;
+static size_t frame_used = 0, last_frame_used = 0, peak_used = 0, reserved = 0;
+
+static ArenaBlock *new_block(size_t size, ArenaBlock *prev)
+{
+    ArenaBlock *block = (ArenaBlock *)malloc(sizeof(ArenaBlock) + size + ARENA_ALIGN);
+    if (!block)
+        return NULL;
+    block->prev = prev;
+    block->size = size;
+    block->used = 0;
+    /* data starts on an aligned address no matter where malloc put the header */
+    uintptr_t start = ((uintptr_t)(block + 1) + ARENA_ALIGN - 1) & ~(uintptr_t)(ARENA_ALIGN - 1);
+    block->data = (char *)start;
+    reserved += size;
+    return block;
+}
+
+static void free_blocks(void)
+{
+    while (current)
+    {
+        ArenaBlock *prev = current->prev;
+        reserved -= current->size;
+        free(current);
+        current = prev;
+    }
+}
+
+void FrameArenaReset(void)
+{
+    last_frame_used = frame_used;
+    if (frame_used > peak_used)
+        peak_used = frame_used;
+    frame_used = 0;
+
+    if (current && current->prev)
+    {
+        /* last frame needed more than one block, replace the chain with one that fits it all */
+        size_t size = current->size;
+        for (ArenaBlock *b = current->prev; b; b = b->prev)
+            size += b->size;
+        free_blocks();
+        current = new_block(size, NULL);
+    }
+    else if (current)
+        current->used = 0;
+}
+
+void FrameArenaShutdown(void)
+{
+    free_blocks();
+    frame_used = last_frame_used = peak_used = 0;
+}
+
+void *FrameAlloc(size_t size)
+{
+    size = (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+    if (!current || current->size - current->used < size)
+    {
+        size_t block_size = current ? current->size * 2 : ARENA_MIN_BLOCK;
+        if (block_size < size)
+            block_size = size;
+        ArenaBlock *block = new_block(block_size, current);
+        if (!block)
+            return NULL;
+        current = block;
+    }
+    void *ptr = current->data + current->used;
+    current->used += size;
+    frame_used += size;
+    return ptr;
+}
+
+const char *FrameFormat(const char *fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    char probe[128];
+    int len = vsnprintf(probe, sizeof(probe), fmt, args);
+    va_end(args);
+    if (len < 0)
+        return "";
+
+    char *out = (char *)FrameAlloc((size_t)len + 1);
+    if (!out)
+        return "";
+    if ((size_t)len < sizeof(probe))
+    {
+        memcpy(out, probe, (size_t)len + 1);
+        return out;
+    }
+    va_start(args, fmt);
+    vsnprintf(out, (size_t)len + 1, fmt, args);
+    va_end(args);
+    return out;
+}
+
+FrameArenaStats FrameArenaGetStats(void)
+{
+    FrameArenaStats stats = {frame_used, last_frame_used, peak_used > frame_used ? peak_used : frame_used, reserved};
+    return stats;
+}
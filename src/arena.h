@@ -0,0 +1,25 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+/* bump allocator for scratch that only lives for one frame: track points, footprint grids, filter lists, formatted
+   strings. everything handed out stays valid until the next FrameArenaReset(), which the main loop calls once per
+   frame. main thread only */
+void FrameArenaReset(void);
+void FrameArenaShutdown(void);
+/* 16 byte aligned, not zeroed. NULL only if the system is out of memory */
+void *FrameAlloc(size_t size);
+/* printf into the arena, for strings TextFormat's four rotating buffers can't hold on to */
+const char *FrameFormat(const char *fmt, ...);
+
+typedef struct
+{
+    size_t used;       // this frame so far
+    size_t last_frame; // what the previous frame took in total
+    size_t peak;       // most any frame took since startup
+    size_t reserved;   // held by the arena right now
+} FrameArenaStats;
+FrameArenaStats FrameArenaGetStats(void);
+
+#endif // ARENA_H
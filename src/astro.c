@@ -1,13 +1,29 @@
 #define _GNU_SOURCE
 #include "astro.h"
+#include "astro_internal.h"
+#include "propagator.h"
+#include "threadpool.h"
 #include "types.h"
 
 #include <math.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/types.h>
 #include <time.h>
+#if !defined(_WIN32) && !defined(_WIN64)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define WIN32_LEAN_AND_MEAN
+#define NOGDI
+#define NOUSER
+typedef struct tagMSG *LPMSG;
+#include <windows.h>
+#endif
 
 #define CSGP4_IMPLEMENTATION
 #include "../lib/csgp4.h"
@@ -17,6 +33,7 @@
 /* WGS-84 ellipsoid constants */
 #define WGS84_A  6378.137
 #define WGS84_E2 0.00669437999014
+#define EARTH_ROT_RAD_S 7.2921159e-5
 
 /* geodetic lat/lon/alt to ECEF using WGS-84 instead of spherical earth */
 void geodetic_to_ecef(double lat_deg, double lon_deg, double alt_m, double *ox, double *oy, double *oz)
@@ -31,23 +48,25 @@ void geodetic_to_ecef(double lat_deg, double lon_deg, double alt_m, double *ox,
     *oz = (N * (1.0 - WGS84_E2) + alt_km) * sin_lat;
 }
 
-Satellite satellites[MAX_SATELLITES];
+Satellite *satellites = NULL; // from alloc_catalog() once anything is loaded
+SatHot *sat_hot = NULL;
 int sat_count = 0;
+unsigned int sat_catalog_rev = 0;
 
 Marker markers[MAX_MARKERS];
 int marker_count = 0;
 
-SatPass passes[MAX_PASSES];
+SatPass *passes = NULL;
 int num_passes = 0;
 Satellite *last_pass_calc_sat = NULL;
+float pass_search_days = 1.0f;
+float pass_search_days_targeted = 3.0f;
 
-/* string extraction (sscanf is a bit too beefy for tight TLE loops) */
-static double parse_tle_double(const char *str, int start, int len)
-{
-    char buf[32] = {0};
-    strncpy(buf, str + start, len);
-    return atof(buf);
-}
+/* polar plot paths live in one shared block, only for passes somebody actually looked at. reset with every new pass list */
+static Vector2 *pass_path_arena = NULL;
+static int pass_path_used = 0;
+static int pass_path_capacity = 0;
+static Marker pass_obs; // observer the current passes[] were computed for
 
 /* pulls the system clock and mashes it into our custom YYYYDDD.FFFF format */
 double get_current_real_time_epoch(void)
@@ -155,485 +174,2409 @@ void epoch_to_datetime_str(double epoch, char *buffer)
     sprintf(buffer, "%04d-%02d-%02d %02d:%02d:%02.0f UTC", year, month, day, h, m, seconds);
 }
 
-/* rips lines from a TLE file and populates the satellite struct */
-bool add_satellite_from_tle(const char* line0, const char* line1, const char* line2)
+/* fixed-width TLE number ("  51.6384", " .00019473", "24108.06679608"): sign, digits and one optional point, padded with
+   spaces. the digits go into an integer that's divided once by an exact power of ten, which rounds the same way atof() does */
+static bool parse_tle_number(const char *s, int len, double *out)
 {
-    if (sat_count >= MAX_SATELLITES) return false;
-    Satellite *sat = &satellites[sat_count];
-
-    strncpy(sat->name, line0, 24);
-    sat->name[24] = '\0';
-    for (int i = 23; i >= 0; i--)
+    static const double pow10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15};
+    int i = 0;
+    while (i < len && s[i] == ' ')
+        i++;
+    bool negative = false;
+    if (i < len && (s[i] == '-' || s[i] == '+'))
+        negative = s[i++] == '-';
+
+    long long mantissa = 0;
+    int digits = 0, decimals = 0;
+    bool point = false;
+    for (; i < len && s[i] != ' '; i++)
     {
-        if (sat->name[i] == ' ' || sat->name[i] == '\r' || sat->name[i] == '\n') sat->name[i] = '\0';
-        else break;
+        char c = s[i];
+        if (c >= '0' && c <= '9')
+        {
+            if (digits == 15)
+                return false;
+            mantissa = mantissa * 10 + (c - '0');
+            digits++;
+            decimals += point;
+        }
+        else if (c == '.' && !point)
+            point = true;
+        else
+            return false;
     }
+    while (i < len && s[i] == ' ')
+        i++;
+    if (i != len || digits == 0)
+        return false;
 
-    memset(&sat->norad_id, 0, sizeof(sat->norad_id));
-    memset(&sat->intl_designator, 0, sizeof(sat->intl_designator));
-    strncpy(sat->norad_id, line1 + 2, sizeof(sat->norad_id));
-    strncpy(sat->intl_designator, line1 + 9, sizeof(sat->intl_designator));
+    double v = (double)mantissa / pow10[decimals];
+    *out = negative ? -v : v;
+    return true;
+}
 
-    char combined[768];
-    snprintf(combined, sizeof(combined), "%s\n%s\n%s\n", line0, line1, line2);
+/* the modulo 10 checksum in column 69: digits count their value, minus signs count one */
+static bool tle_checksum_ok(const char *line)
+{
+    int sum = 0;
+    for (int i = 0; i < 68; i++)
+    {
+        char c = line[i];
+        if (c >= '0' && c <= '9')
+            sum += c - '0';
+        else if (c == '-')
+            sum++;
+    }
+    return line[68] >= '0' && line[68] <= '9' && line[68] - '0' == sum % 10;
+}
 
-    struct TLEObject *parsed_objs = NULL;
-    int num_objs = 0;
-    ParseFileOrString(NULL, combined, &parsed_objs, &num_objs);
+/* assumed-decimal exponent fields (" 34469-3"), handed to the same routine csgp4 uses so sgp4init sees identical values */
+static float parse_tle_exponential(const char *s)
+{
+    char buf[9];
+    memcpy(buf, s, 8);
+    buf[8] = '\0';
+    int aborted = 0;
+    return ParseFixedEponential(buf, 0, &aborted);
+}
 
-    if (num_objs > 0 && parsed_objs != NULL)
-    {
-        double initial_r[3] = {0};
-        double initial_v[3] = {0};
+/* single pass over the fixed TLE columns, filling the satellite and the sgp4init input side by side without touching the
+   heap. lines come with their lengths so they can point straight into a file buffer. NULL if fine, otherwise what's wrong */
+const char *parse_tle_record(const char *line0, int len0, const char *line1, int len1, const char *line2, int len2, Satellite *sat,
+                             struct TLEObject *obj)
+{
+    while (len1 > 0 && (line1[len1 - 1] == '\r' || line1[len1 - 1] == '\n'))
+        len1--;
+    while (len2 > 0 && (line2[len2 - 1] == '\r' || line2[len2 - 1] == '\n'))
+        len2--;
+
+    if (len1 < 69 || len2 < 69)
+        return "line too short";
+    if (line1[0] != '1' || line1[1] != ' ' || line2[0] != '2' || line2[1] != ' ')
+        return "bad line numbers";
+    if (!tle_checksum_ok(line1))
+        return "line 1 checksum mismatch";
+    if (!tle_checksum_ok(line2))
+        return "line 2 checksum mismatch";
+    if (memcmp(line1 + 2, line2 + 2, 5) != 0)
+        return "catalog numbers differ between lines";
+
+    const double xpdotp = 1440.0 / (2.0 * SGPPI);
+    double raw_epoch, epoch_day, ndot, incl, raan, ecc, argp, ma, revs;
+    if (!parse_tle_number(line1 + 18, 14, &raw_epoch) || !parse_tle_number(line1 + 20, 12, &epoch_day) || !parse_tle_number(line1 + 33, 10, &ndot) ||
+        !parse_tle_number(line2 + 8, 8, &incl) || !parse_tle_number(line2 + 17, 8, &raan) || !parse_tle_number(line2 + 26, 7, &ecc) ||
+        !parse_tle_number(line2 + 34, 8, &argp) || !parse_tle_number(line2 + 43, 8, &ma) || !parse_tle_number(line2 + 52, 11, &revs))
+        return "malformed number";
+    if (revs <= 0.0)
+        return "zero mean motion";
+
+    int name_len = len0 < 24 ? len0 : 24;
+    while (name_len > 0 && (line0[name_len - 1] == ' ' || line0[name_len - 1] == '\r' || line0[name_len - 1] == '\n'))
+        name_len--;
+    memcpy(sat->name, line0, name_len);
+    sat->name[name_len] = '\0';
+    memcpy(sat->norad_id, line1 + 2, sizeof(sat->norad_id));
+    memcpy(sat->intl_designator, line1 + 9, sizeof(sat->intl_designator));
+
+    int yy = (int)(raw_epoch / 1000.0);
+    int year = (yy < 57) ? 2000 + yy : 1900 + yy;
+    sat->epoch_days = (year * 1000.0) + fmod(raw_epoch, 1000.0);
+    sat->epoch_unix = get_unix_from_epoch(sat->epoch_days);
+    sat->inclination = incl * DEG2RAD;
+    sat->raan = raan * DEG2RAD;
+    sat->eccentricity = ecc / 1e7;
+    sat->arg_perigee = argp * DEG2RAD;
+    sat->mean_anomaly = ma * DEG2RAD;
+    sat->mean_motion = (revs * 2.0 * PI) / 86400.0;
+    sat->semi_major_axis = pow(MU / (sat->mean_motion * sat->mean_motion), 1.0 / 3.0);
+
+    /* same units and epoch bookkeeping ParseFileOrString() hands to ConvertTLEToSGP4() */
+    const double deg2rad = SGPPI / 180.0;
+    memset(obj, 0, sizeof(*obj));
+    obj->dragTerm = parse_tle_exponential(line1 + 53);
+    obj->meanMotion2 = parse_tle_exponential(line1 + 44) / (xpdotp * 1440.0 * 1440);
+    obj->meanMotion1 = ndot / (xpdotp * 1440.0);
+    obj->inclination = incl * deg2rad;
+    obj->rightAscensionOfTheAscendingNode = raan * deg2rad;
+    obj->eccentricity = ecc * 0.0000001;
+    obj->argumentOfPerigee = argp * deg2rad;
+    obj->meanAnomaly = ma * deg2rad;
+    obj->meanMotion = revs / xpdotp;
+
+    int mon, day, hr, minute;
+    SGPF sec;
+    days2mdhms(year, epoch_day, &mon, &day, &hr, &minute, &sec);
+    jday(year, mon, day, hr, minute, sec, &obj->jdsatepoch, &obj->jdsatepochF);
+    obj->valid = 1;
+    return NULL;
+}
 
-        /* shove the TLE into the sgp4 state machine */
-        ConvertTLEToSGP4(&sat->satrec, &parsed_objs[0], 0.0, initial_r, initial_v);
-        free(parsed_objs);
+static SatHot *catalog_hot(Satellite *catalog);
 
-        /* manual scraping for the rest of the struct because we like control */
-        double raw_epoch = parse_tle_double(line1, 18, 14);
-        int yy = (int)(raw_epoch / 1000.0);
-        int year = (yy < 57) ? 2000 + yy : 1900 + yy;
-        sat->epoch_days = (year * 1000.0) + fmod(raw_epoch, 1000.0);
-        sat->epoch_unix = get_unix_from_epoch(sat->epoch_days);
-        sat->inclination = parse_tle_double(line2, 8, 8) * DEG2RAD;
-        sat->raan = parse_tle_double(line2, 17, 8) * DEG2RAD;
+/* parses one record into a catalog slot and brings up its sgp4 state. touches nothing but that slot, so any number of
+   these can run side by side. NULL on success, otherwise why it got rejected */
+static const char *init_satellite_slot(Satellite *catalog, int slot, const char *line0, int len0, const char *line1, int len1, const char *line2, int len2)
+{
+    Satellite *sat = &catalog[slot];
+    struct TLEObject obj;
+    const char *error = parse_tle_record(line0, len0, line1, len1, line2, len2, sat, &obj);
+    if (error)
+        return error;
+
+    /* shove the TLE into the sgp4 state machine */
+    double initial_r[3] = {0};
+    double initial_v[3] = {0};
+    ConvertTLEToSGP4(&sat->satrec, &obj, 0.0, initial_r, initial_v);
+    memset(&sat->resonance, 0, sizeof(sat->resonance));
+    sat->orbit_cached = false;
+    catalog_hot(catalog)[slot].is_active = true;
+    return NULL;
+}
 
-        char ecc_buf[32] = "0.";
-        strncpy(ecc_buf + 2, line2 + 26, 7);
-        sat->eccentricity = atof(ecc_buf);
+/* a catalog is one address space reservation: a page of bookkeeping, then CATALOG_RESERVE_SLOTS satellites, then as
+   many SatHot. only the first committed slots of both are backed by memory. growing commits the next chunks in place,
+   so the catalog never moves and Satellite pointers into it (selection, passes, locked pass) survive it filling up.
+   fresh pages come zeroed */
+#define CATALOG_HEADER_BYTES 4096
+#define CATALOG_HOT_ALIGN 65536 // keeps every chunk of the hot array on whole pages, 16k and 64k ones included
 
-        sat->arg_perigee = parse_tle_double(line2, 34, 8) * DEG2RAD;
-        sat->mean_anomaly = parse_tle_double(line2, 43, 8) * DEG2RAD;
+typedef struct
+{
+    int committed; // slots backed by memory, a multiple of CATALOG_CHUNK_SLOTS
+} CatalogHeader;
 
-        double revs_per_day = parse_tle_double(line2, 52, 11);
-        sat->mean_motion = (revs_per_day * 2.0 * PI) / 86400.0;
-        sat->semi_major_axis = pow(MU / (sat->mean_motion * sat->mean_motion), 1.0 / 3.0);
-        sat->is_active = true;
-        sat_count++;
-        return true;
-    }
-    return false;
+static CatalogHeader *catalog_header(Satellite *catalog)
+{
+    return (CatalogHeader *)((char *)catalog - CATALOG_HEADER_BYTES);
 }
 
-/* bulk loading of celestial junk from flat files */
-void load_tle_data(const char *filename)
+/* from the first slot to the first hot entry */
+static size_t catalog_hot_offset(void)
 {
-    FILE *file = fopen(filename, "r");
-    if (!file)
-    {
-        printf("Failed to open %s\n", filename);
-        return;
-    }
-
-    sat_count = 0;
-    char line0[256];
+    size_t cold = (size_t)CATALOG_RESERVE_SLOTS * sizeof(Satellite);
+    return (CATALOG_HEADER_BYTES + cold + CATALOG_HOT_ALIGN - 1) / CATALOG_HOT_ALIGN * CATALOG_HOT_ALIGN - CATALOG_HEADER_BYTES;
+}
 
-    /* Check for custom header to restore TLE Manager state */
-    if (fgets(line0, sizeof(line0), file))
-    {
-        if (strncmp(line0, "# EPOCH:", 8) != 0)
-        {
-            rewind(file); /* not a header, restart */
-        }
-    }
+static SatHot *catalog_hot(Satellite *catalog)
+{
+    return (SatHot *)((char *)catalog + catalog_hot_offset());
+}
 
-    char line1[256], line2[256];
-    while (fgets(line0, sizeof(line0), file))
-    {
-        if (line0[0] == '#' || line0[0] == '\n' || line0[0] == '\r')
-            continue;
+static size_t catalog_reserve_bytes(void)
+{
+    return CATALOG_HEADER_BYTES + catalog_hot_offset() + (size_t)CATALOG_RESERVE_SLOTS * sizeof(SatHot);
+}
 
-        if (fgets(line1, sizeof(line1), file) && fgets(line2, sizeof(line2), file))
-        {
-            line0[strcspn(line0, "\r\n")] = 0;
-            line1[strcspn(line1, "\r\n")] = 0;
-            line2[strcspn(line2, "\r\n")] = 0;
-            add_satellite_from_tle(line0, line1, line2);
-        }
-    }
-    fclose(file);
+static bool commit_pages(char *start, size_t size)
+{
+#if !defined(_WIN32) && !defined(_WIN64)
+    /* with pages bigger than the header (16k on apple silicon) a chunk can start mid-page. mprotect wants whole pages,
+       and the part before start is committed already anyway */
+    uintptr_t page = (uintptr_t)sysconf(_SC_PAGESIZE);
+    uintptr_t from = (uintptr_t)start & ~(page - 1);
+    return mprotect((void *)from, (uintptr_t)start + size - from, PROT_READ | PROT_WRITE) == 0;
+#else
+    return VirtualAlloc(start, size, MEM_COMMIT, PAGE_READWRITE) != NULL;
+#endif
 }
 
-/* parsing for strings that were likely copy-pasted in a hurry */
-void load_manual_tles(AppConfig *config)
+Satellite *alloc_catalog(void)
 {
-    for (int i = 0; i < config->manual_tle_count; i++)
+    size_t size = catalog_reserve_bytes();
+#if !defined(_WIN32) && !defined(_WIN64)
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#ifdef MAP_NORESERVE
+    flags |= MAP_NORESERVE;
+#endif
+    char *base = (char *)mmap(NULL, size, PROT_NONE, flags, -1, 0);
+    if (base == (char *)MAP_FAILED)
+        base = NULL;
+#else
+    char *base = (char *)VirtualAlloc(NULL, size, MEM_RESERVE, PAGE_NOACCESS);
+#endif
+    if (!base || !commit_pages(base, CATALOG_HEADER_BYTES))
     {
-        char temp[512];
-        strcpy(temp, config->manual_tles[i]);
+        fprintf(stderr, "Failed to reserve the satellite catalog\n");
+        return NULL;
+    }
+    Satellite *catalog = (Satellite *)(base + CATALOG_HEADER_BYTES);
+    catalog_header(catalog)->committed = 0;
+    grow_catalog(catalog, 1);
+    return catalog;
+}
 
-        char *line0 = temp;
-        char *line1 = strchr(line0, '|');
-        if (!line1) continue;
-        *line1 = '\0';
-        line1++;
+int grow_catalog(Satellite *catalog, int count)
+{
+    CatalogHeader *header = catalog_header(catalog);
+    if (count <= header->committed)
+        return header->committed;
+    if (count > CATALOG_RESERVE_SLOTS)
+        count = CATALOG_RESERVE_SLOTS;
+
+    int target = (count + CATALOG_CHUNK_SLOTS - 1) / CATALOG_CHUNK_SLOTS * CATALOG_CHUNK_SLOTS;
+    if (target > CATALOG_RESERVE_SLOTS)
+        target = CATALOG_RESERVE_SLOTS;
+    int from = header->committed;
+    if (target > from && commit_pages((char *)&catalog[from], (size_t)(target - from) * sizeof(Satellite)) &&
+        commit_pages((char *)&catalog_hot(catalog)[from], (size_t)(target - from) * sizeof(SatHot)))
+        header->committed = target;
+    else if (target > header->committed)
+        fprintf(stderr, "Out of memory growing the catalog past %d satellites\n", header->committed);
+    return header->committed;
+}
 
-        char *line2 = strchr(line1, '|');
-        if (!line2) continue;
-        *line2 = '\0';
-        line2++;
+static int orbit_cache_count = 0; // allocated orbit caches, for catalog_memory_bytes()
+static unsigned int orbit_cache_generation = 0;
 
-        add_satellite_from_tle(line0, line1, line2);
-    }
+void release_orbit_cache(Satellite *sat)
+{
+    if (!sat->orbit_cache)
+        return;
+    free(sat->orbit_cache);
+    sat->orbit_cache = NULL;
+    sat->orbit_cached = false;
+    orbit_cache_count--;
 }
 
-/* main sgp4 crank; outputs raw ECI coordinates */
-/* precalculated unix time passed down to prevent excessyear/day conversions */
-Vector3 calculate_position(Satellite *sat, double current_unix)
+/* catalog[dst] = catalog[src] for slots that own an orbit cache: dst's goes away, src's moves over */
+static void move_satellite(Satellite *catalog, int dst, int src)
 {
-    double tsince = (current_unix - sat->epoch_unix) / 60.0;
-
-    double ro[3] = {0};
-    double vo[3] = {0};
+    if (dst == src)
+        return;
+    release_orbit_cache(&catalog[dst]);
+    catalog[dst] = catalog[src];
+    catalog_hot(catalog)[dst] = catalog_hot(catalog)[src];
+    catalog[src].orbit_cache = NULL;
+    catalog[src].orbit_cached = false;
+}
 
-    sgp4(&sat->satrec, tsince, ro, vo);
+void free_catalog(Satellite *catalog, int count)
+{
+    if (!catalog)
+        return;
+    for (int i = 0; i < count; i++)
+        release_orbit_cache(&catalog[i]);
+    char *base = (char *)catalog_header(catalog);
+#if !defined(_WIN32) && !defined(_WIN64)
+    munmap(base, catalog_reserve_bytes());
+#else
+    VirtualFree(base, 0, MEM_RELEASE);
+#endif
+}
 
-    Vector3 pos;
-    pos.x = (float)(ro[0]);
-    pos.y = (float)(ro[2]);
-    pos.z = (float)(-ro[1]);
+static size_t pass_cache_memory_bytes(void);
 
-    return pos;
+size_t catalog_memory_bytes(void)
+{
+    size_t committed = satellites ? (size_t)catalog_header(satellites)->committed : 0;
+    return (satellites ? CATALOG_HEADER_BYTES : 0) + committed * (sizeof(Satellite) + sizeof(SatHot)) +
+           (size_t)orbit_cache_count * ORBIT_CACHE_SIZE * sizeof(Vector3) + pass_cache_memory_bytes();
 }
 
-/* projects 3D orbital space onto a 2D equirectangular map plane */
-void get_map_coordinates(Vector3 pos, double gmst_deg, float earth_offset, float map_w, float map_h, float *out_x, float *out_y)
+static bool ensure_catalog(void)
 {
-    float r = Vector3Length(pos);
-    if (r == 0)
-        r = 0.0001f;
-    float phi = acosf(pos.y / r);
-    float v = phi / PI;
+    if (!satellites && (satellites = alloc_catalog()))
+        sat_hot = catalog_hot(satellites);
+    return satellites != NULL;
+}
 
-    float theta_sat = atan2f(-pos.z, pos.x);
-    float R_rad = (gmst_deg + earth_offset) * DEG2RAD;
-    float theta_tex = theta_sat - R_rad;
+SatHot *satellite_hot(const Satellite *sat)
+{
+    return &sat_hot[sat - satellites];
+}
 
-    while (theta_tex > PI)
-        theta_tex -= 2.0f * PI;
-    while (theta_tex < -PI)
-        theta_tex += 2.0f * PI;
+/* --- catalog number index: open addressing, linear probing, at most half full --- */
 
-    float u = theta_tex / (2.0f * PI) + 0.5f;
-    *out_x = (u - 0.5f) * map_w;
-    *out_y = (v - 0.5f) * map_h;
+int norad_number(const char *norad_id)
+{
+    /* alpha-5 puts a letter in front of four digits for numbers past 99999, I and O skipped */
+    static const char alpha5[] = "ABCDEFGHJKLMNPQRSTUVWXYZ";
+    int value = 0, i = 0;
+    while (i < 4 && norad_id[i] == ' ')
+        i++;
+    if (i == 0 && norad_id[0] >= 'A' && norad_id[0] <= 'Z')
+    {
+        const char *letter = strchr(alpha5, norad_id[0]);
+        if (!letter)
+            return -1;
+        value = 10 + (int)(letter - alpha5);
+        i = 1;
+    }
+    for (; i < 5; i++)
+    {
+        if (norad_id[i] < '0' || norad_id[i] > '9')
+            return -1;
+        value = value * 10 + (norad_id[i] - '0');
+    }
+    return value;
 }
 
-/* finds where the sat hits the high and low points of its orbit in 2D */
-void get_apsis_2d(Satellite *sat, double current_time, bool is_apoapsis, double gmst_deg, float earth_offset, float map_w, float map_h, Vector2 *out)
+typedef struct
 {
-    (void)gmst_deg;
+    int norad; // -1 for an empty bucket
+    int slot;
+} NoradBucket;
 
-    double current_unix = get_unix_from_epoch(current_time);
-    double delta_time_s = current_unix - sat->epoch_unix;
+typedef struct
+{
+    NoradBucket *buckets;
+    int mask;
+} NoradTable;
 
-    double M = fmod(sat->mean_anomaly + sat->mean_motion * delta_time_s, 2.0 * PI);
-    if (M < 0)
-        M += 2.0 * PI;
+static bool norad_table_init(NoradTable *table, int count)
+{
+    int size = 64;
+    while (size < count * 2)
+        size *= 2;
+    table->buckets = (NoradBucket *)malloc(sizeof(NoradBucket) * size);
+    table->mask = size - 1;
+    if (!table->buckets)
+        return false;
+    for (int i = 0; i < size; i++)
+        table->buckets[i].norad = -1;
+    return true;
+}
 
-    double target_M = is_apoapsis ? PI : 0.0;
-    double diff = target_M - M;
-    if (diff < 0)
-        diff += 2.0 * PI;
+static NoradBucket *norad_table_bucket(const NoradTable *table, int norad)
+{
+    uint32_t h = ((uint32_t)norad * 2654435761u) & (uint32_t)table->mask;
+    while (table->buckets[h].norad >= 0 && table->buckets[h].norad != norad)
+        h = (h + 1) & (uint32_t)table->mask;
+    return &table->buckets[h];
+}
 
-    double t_target = current_time + (diff / sat->mean_motion) / 86400.0;
-    double t_target_unix = get_unix_from_epoch(t_target);
-    Vector3 pos3d = calculate_position(sat, t_target_unix);
-    double gmst_target = epoch_to_gmst(t_target);
+static NoradTable norad_index = {NULL, 0};
+static const Satellite *norad_index_catalog = NULL;
+static unsigned int norad_index_rev = 0;
+static bool norad_index_valid = false;
 
-    get_map_coordinates(pos3d, gmst_target, earth_offset, map_w, map_h, &out->x, &out->y);
+/* every loader bumps sat_catalog_rev, so the index just notices it's stale and rebuilds on the next lookup */
+int find_satellite_slot(int norad)
+{
+    if (norad < 0 || sat_count == 0)
+        return -1;
+    if (!norad_index_valid || norad_index_rev != sat_catalog_rev || norad_index_catalog != satellites)
+    {
+        free(norad_index.buckets);
+        norad_index_valid = norad_table_init(&norad_index, sat_count);
+        if (!norad_index_valid)
+            return -1;
+        for (int i = 0; i < sat_count; i++)
+        {
+            int id = norad_number(satellites[i].norad_id);
+            NoradBucket *bucket = (id >= 0) ? norad_table_bucket(&norad_index, id) : NULL;
+            if (bucket && bucket->norad < 0)
+                *bucket = (NoradBucket){id, i};
+        }
+        norad_index_rev = sat_catalog_rev;
+        norad_index_catalog = satellites;
+    }
+    NoradBucket *bucket = norad_table_bucket(&norad_index, norad);
+    return bucket->norad == norad ? bucket->slot : -1;
 }
 
-/* predicts the timestamps for the next perigee and apoapsis */
-void get_apsis_times(Satellite *sat, double current_time, double *out_peri_unix, double *out_apo_unix)
+int merge_duplicate_satellites(Satellite *catalog, int count)
 {
-    double current_unix = get_unix_from_epoch(current_time);
-    double delta_time_s = current_unix - sat->epoch_unix;
+    NoradTable table;
+    if (count <= 1 || !norad_table_init(&table, count))
+        return count;
 
-    double M = fmod(sat->mean_anomaly + sat->mean_motion * delta_time_s, 2.0 * PI);
-    if (M < 0)
-        M += 2.0 * PI;
+    int kept = 0, merged = 0;
+    for (int i = 0; i < count; i++)
+    {
+        int id = norad_number(catalog[i].norad_id);
+        NoradBucket *bucket = (id >= 0) ? norad_table_bucket(&table, id) : NULL;
+        if (bucket && bucket->norad >= 0)
+        {
+            if (catalog[i].epoch_unix > catalog[bucket->slot].epoch_unix)
+                move_satellite(catalog, bucket->slot, i);
+            else
+                release_orbit_cache(&catalog[i]);
+            merged++;
+            continue;
+        }
+        if (bucket)
+            *bucket = (NoradBucket){id, kept};
+        move_satellite(catalog, kept, i);
+        kept++;
+    }
+    free(table.buckets);
+    return kept;
+}
 
-    double diff_peri = 0.0 - M;
-    if (diff_peri < 0)
-        diff_peri += 2.0 * PI;
-    double diff_apo = PI - M;
-    if (diff_apo < 0)
-        diff_apo += 2.0 * PI;
+/* a whole file in memory for the line scanner: mapped where the OS lets us, one read into the heap otherwise */
+typedef struct
+{
+    const char *data;
+    size_t size;
+    bool mapped;
+} FileView;
 
-    double t_peri = current_time + (diff_peri / sat->mean_motion) / 86400.0;
-    double t_apo = current_time + (diff_apo / sat->mean_motion) / 86400.0;
+static bool open_file_view(const char *filename, FileView *view)
+{
+    memset(view, 0, sizeof(*view));
+#if !defined(_WIN32) && !defined(_WIN64)
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    bool empty = false;
+    if (fstat(fd, &st) == 0 && !(empty = st.st_size == 0))
+    {
+        void *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED)
+        {
+            madvise(data, (size_t)st.st_size, MADV_SEQUENTIAL);
+            view->data = (const char *)data;
+            view->size = (size_t)st.st_size;
+            view->mapped = true;
+        }
+    }
+    close(fd);
+    if (empty || view->mapped)
+        return true;
+#else
+    HANDLE file_handle = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file_handle == INVALID_HANDLE_VALUE)
+        return false;
+    LARGE_INTEGER file_size;
+    bool empty = false;
+    if (GetFileSizeEx(file_handle, &file_size) && !(empty = file_size.QuadPart == 0) && (uint64_t)file_size.QuadPart <= SIZE_MAX)
+    {
+        /* the view keeps the mapping alive, both handles can go right away */
+        HANDLE mapping = CreateFileMappingA(file_handle, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mapping)
+        {
+            void *data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            if (data)
+            {
+                view->data = (const char *)data;
+                view->size = (size_t)file_size.QuadPart;
+                view->mapped = true;
+            }
+            CloseHandle(mapping);
+        }
+    }
+    CloseHandle(file_handle);
+    if (empty || view->mapped)
+        return true;
+#endif
+    FILE *file = fopen(filename, "rb");
+    if (!file)
+        return false;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char *buf = (size > 0) ? (char *)malloc((size_t)size) : NULL;
+    if (buf)
+        view->size = fread(buf, 1, (size_t)size, file);
+    fclose(file);
+    view->data = buf;
+    return true;
+}
 
-    *out_peri_unix = get_unix_from_epoch(t_peri);
-    *out_apo_unix = get_unix_from_epoch(t_apo);
+static void close_file_view(FileView *view)
+{
+#if !defined(_WIN32) && !defined(_WIN64)
+    if (view->mapped)
+        munmap((void *)view->data, view->size);
+#else
+    if (view->mapped)
+        UnmapViewOfFile(view->data);
+#endif
+    else
+        free((void *)view->data);
+    memset(view, 0, sizeof(*view));
 }
 
-/* Calculates cache resolution based on orbital eccentricity */
-int calculate_orbit_cache_resolution(double eccentricity, int active_sat_count, int total_sat_count)
+bool replace_file(const char *tmp_path, const char *path)
 {
-    (void)active_sat_count;  // unused
-    (void)total_sat_count;   // unused
-    
-    // Low eccentricity
-    if (eccentricity < 0.05)
-        return 180;
-    // Moderate eccentricity
-    if (eccentricity < 0.3)
-        return 270;
-    // High eccentricity
-    return 361;
+#if !defined(_WIN32) && !defined(_WIN64)
+    return rename(tmp_path, path) == 0;
+#else
+    return MoveFileExA(tmp_path, path, MOVEFILE_REPLACE_EXISTING) != 0;
+#endif
 }
 
-/* Checks if cached orbit is still valid based on satellite drift */
-bool is_orbit_cache_valid(Satellite *sat, Vector3 current_pos, float drift_threshold_km)
+/* hands out the next line in place: start and length without the line break (CRLF or LF), false once the view is used up */
+static bool next_line(const char **cursor, const char *end, const char **line, int *len)
 {
-    if (!sat->orbit_cached)
+    const char *p = *cursor;
+    if (p >= end)
         return false;
-    
-    float drift = Vector3Distance(sat->cached_orbit_base_pos, current_pos);
-    return drift < drift_threshold_km;
+    const char *nl = (const char *)memchr(p, '\n', (size_t)(end - p));
+    const char *stop = nl ? nl : end;
+    if (stop > p && stop[-1] == '\r')
+        stop--;
+    *line = p;
+    *len = (int)(stop - p);
+    *cursor = nl ? nl + 1 : end;
+    return true;
 }
 
-/* bakes the future orbital path into a vertex buffer so sgp4 isnt re-ran every frame */
-void update_orbit_cache(Satellite *sat, double current_epoch)
+/* --- precompiled catalog: the parsed and sgp4init'ed satellites of a TLE file, next to it as <file>.cache --- */
+
+#define CATALOG_CACHE_MAGIC "TLESCAT"
+#define CATALOG_CACHE_VERSION 1 // bump whenever parsing or sgp4init would give different results
+
+typedef struct
 {
-    sat->orbit_cache_resolution = calculate_orbit_cache_resolution(sat->eccentricity, 0, sat_count);
-    
-    double period_days = (2.0 * PI / sat->mean_motion) / 86400.0;
-    double time_step = period_days / (sat->orbit_cache_resolution - 1);
-    
-    for (int i = 0; i < sat->orbit_cache_resolution; i++)
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size; // layout check, a different build or compiler invalidates the file
+    uint32_t satrec_size;
+    int32_t count;
+    uint64_t source_size;
+    uint64_t source_hash; // of the whole TLE file
+    uint64_t payload_hash;
+} CatalogCacheHeader;
+
+typedef struct
+{
+    char name[32];
+    char norad_id[6];
+    char intl_designator[8];
+    double epoch_days;
+    double epoch_unix;
+    double inclination;
+    double raan;
+    double eccentricity;
+    double arg_perigee;
+    double mean_anomaly;
+    double mean_motion;
+    double semi_major_axis;
+    struct elsetrec satrec;
+} CatalogCacheRecord;
+
+#define HASH_SEED 1469598103934665603ULL
+
+/* FNV-1a on 8 byte words, the tail byte by byte. not cryptographic, just enough to notice a changed or torn file.
+   hashing piece by piece from the last h gives the same result as one go, as long as every piece but the last is a
+   multiple of 8 bytes long */
+static uint64_t hash_bytes_from(uint64_t h, const void *data, size_t size)
+{
+    const unsigned char *p = (const unsigned char *)data;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8)
     {
-        double t = current_epoch + (i * time_step);
-        double t_unix = get_unix_from_epoch(t);
-        sat->orbit_cache[i] = Vector3Scale(calculate_position(sat, t_unix), 1.0f / DRAW_SCALE);
+        uint64_t w;
+        memcpy(&w, p + i, 8);
+        h = (h ^ w) * 1099511628211ULL;
     }
-    
-    // Track cache validity
-    double current_unix = get_unix_from_epoch(current_epoch);
-    sat->cached_orbit_base_pos = calculate_position(sat, current_unix);
-    sat->cached_orbit_epoch = current_epoch;
-    sat->orbit_cached = true;
+    for (; i < size; i++)
+        h = (h ^ p[i]) * 1099511628211ULL;
+    return h;
 }
 
-/* converts raw orbital data into azimuth/elevation for a specific ground station */
-void get_az_el(Vector3 eci_pos, double gmst_deg, float obs_lat, float obs_lon, float obs_alt, double *az, double *el)
+static uint64_t hash_bytes(const void *data, size_t size)
 {
-    double sat_r = Vector3Length(eci_pos);
-    if (sat_r == 0)
-    {
-        *az = 0;
-        *el = -90;
-        return;
-    }
+    return hash_bytes_from(HASH_SEED, data, size);
+}
 
-    double sat_lat = asin(eci_pos.y / sat_r);
-    double sat_lon_eci = atan2(-eci_pos.z, eci_pos.x);
-    double theta = (gmst_deg + 0) * DEG2RAD; /* assuming earth_rotation_offset handled befor */
-    double sat_lon_ecef = sat_lon_eci - theta;
+static void catalog_cache_path(const char *filename, char *out, size_t size)
+{
+    snprintf(out, size, "%s.cache", filename);
+}
 
-    double s_x = sat_r * cos(sat_lat) * cos(sat_lon_ecef);
-    double s_y = sat_r * cos(sat_lat) * sin(sat_lon_ecef);
-    double s_z = sat_r * sin(sat_lat);
+static void catalog_record_from_sat(CatalogCacheRecord *rec, const Satellite *sat)
+{
+    memcpy(rec->name, sat->name, sizeof(rec->name));
+    memcpy(rec->norad_id, sat->norad_id, sizeof(rec->norad_id));
+    memcpy(rec->intl_designator, sat->intl_designator, sizeof(rec->intl_designator));
+    rec->epoch_days = sat->epoch_days;
+    rec->epoch_unix = sat->epoch_unix;
+    rec->inclination = sat->inclination;
+    rec->raan = sat->raan;
+    rec->eccentricity = sat->eccentricity;
+    rec->arg_perigee = sat->arg_perigee;
+    rec->mean_anomaly = sat->mean_anomaly;
+    rec->mean_motion = sat->mean_motion;
+    rec->semi_major_axis = sat->semi_major_axis;
+    rec->satrec = sat->satrec;
+}
 
-    double o_x, o_y, o_z;
-    geodetic_to_ecef(obs_lat, obs_lon, obs_alt, &o_x, &o_y, &o_z);
+static void sat_from_catalog_record(Satellite *catalog, int slot, const CatalogCacheRecord *rec)
+{
+    Satellite *sat = &catalog[slot];
+    memcpy(sat->name, rec->name, sizeof(sat->name));
+    sat->name[sizeof(sat->name) - 1] = '\0';
+    memcpy(sat->norad_id, rec->norad_id, sizeof(sat->norad_id));
+    memcpy(sat->intl_designator, rec->intl_designator, sizeof(sat->intl_designator));
+    sat->epoch_days = rec->epoch_days;
+    sat->epoch_unix = rec->epoch_unix;
+    sat->inclination = rec->inclination;
+    sat->raan = rec->raan;
+    sat->eccentricity = rec->eccentricity;
+    sat->arg_perigee = rec->arg_perigee;
+    sat->mean_anomaly = rec->mean_anomaly;
+    sat->mean_motion = rec->mean_motion;
+    sat->semi_major_axis = rec->semi_major_axis;
+    sat->satrec = rec->satrec;
+    memset(&sat->resonance, 0, sizeof(sat->resonance));
+    sat->orbit_cached = false;
+    catalog_hot(catalog)[slot].is_active = true;
+}
 
-    double dx = s_x - o_x;
-    double dy = s_y - o_y;
-    double dz = s_z - o_z;
+/* fills satellites[] from the cache if it was built from exactly this TLE file, false means parse the text */
+static bool load_catalog_cache(const char *filename, uint64_t source_hash, uint64_t source_size)
+{
+    char path[512];
+    catalog_cache_path(filename, path, sizeof(path));
+    FileView view;
+    if (!open_file_view(path, &view))
+        return false;
 
-    double lat_rad = obs_lat * DEG2RAD;
+    bool ok = false;
+    CatalogCacheHeader header;
+    if (view.size >= sizeof(header))
+    {
+        memcpy(&header, view.data, sizeof(header));
+        const char *payload = view.data + sizeof(header);
+        size_t payload_size = view.size - sizeof(header);
+        ok = memcmp(header.magic, CATALOG_CACHE_MAGIC, sizeof(header.magic)) == 0 && header.version == CATALOG_CACHE_VERSION &&
+             header.record_size == sizeof(CatalogCacheRecord) && header.satrec_size == sizeof(struct elsetrec) && header.count >= 0 &&
+             header.count <= CATALOG_RESERVE_SLOTS && header.source_size == source_size && header.source_hash == source_hash &&
+             payload_size == (size_t)header.count * sizeof(CatalogCacheRecord) && hash_bytes(payload, payload_size) == header.payload_hash &&
+             grow_catalog(satellites, header.count) >= header.count;
+
+        for (int i = 0; ok && i < header.count; i++)
+        {
+            CatalogCacheRecord rec;
+            memcpy(&rec, payload + (size_t)i * sizeof(rec), sizeof(rec));
+            sat_from_catalog_record(satellites, i, &rec);
+        }
+        if (ok)
+            sat_count = header.count;
+    }
+    close_file_view(&view);
+    return ok;
+}
+
+#define CACHE_WRITE_CHUNK 64 // records converted and hashed at a time, the catalog is never copied whole
+
+/* writes sats[0, count) out for the next launch. goes through a temp file and a rename so a crash halfway can't leave a
+   cache that looks valid. the payload hash is only known at the end, so the header is written twice */
+static void write_catalog_cache(const char *filename, const Satellite *sats, int count, uint64_t source_hash, uint64_t source_size)
+{
+    char path[512], tmp_path[520];
+    catalog_cache_path(filename, path, sizeof(path));
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+
+    CatalogCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CATALOG_CACHE_MAGIC, sizeof(CATALOG_CACHE_MAGIC));
+    header.version = CATALOG_CACHE_VERSION;
+    header.record_size = sizeof(CatalogCacheRecord);
+    header.satrec_size = sizeof(struct elsetrec);
+    header.count = count;
+    header.source_size = source_size;
+    header.source_hash = source_hash;
+
+    /* records hold doubles, so their size is a multiple of 8 and chunk by chunk hashing matches hash_bytes() on load */
+    CatalogCacheRecord *chunk = (CatalogCacheRecord *)malloc(sizeof(CatalogCacheRecord) * CACHE_WRITE_CHUNK);
+    FILE *file = chunk ? fopen(tmp_path, "wb") : NULL;
+    bool written = file && fwrite(&header, sizeof(header), 1, file) == 1;
+    uint64_t payload_hash = HASH_SEED;
+    for (int i = 0; written && i < count; i += CACHE_WRITE_CHUNK)
+    {
+        int n = (count - i < CACHE_WRITE_CHUNK) ? count - i : CACHE_WRITE_CHUNK;
+        memset(chunk, 0, sizeof(CatalogCacheRecord) * n); /* padding too, same catalog gives the same file */
+        for (int k = 0; k < n; k++)
+            catalog_record_from_sat(&chunk[k], &sats[i + k]);
+        payload_hash = hash_bytes_from(payload_hash, chunk, sizeof(CatalogCacheRecord) * n);
+        written = fwrite(chunk, sizeof(CatalogCacheRecord), n, file) == (size_t)n;
+    }
+    header.payload_hash = payload_hash;
+    written = written && fseek(file, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, file) == 1;
+    if (file && fclose(file) != 0)
+        written = false;
+    free(chunk);
+
+    if (!written || !replace_file(tmp_path, path))
+    {
+        fprintf(stderr, "Failed to write catalog cache %s\n", path);
+        remove(tmp_path);
+    }
+}
+
+/* satellites[0, sat_count) as the cache of filename */
+static void save_catalog_cache(const char *filename, uint64_t source_hash, uint64_t source_size)
+{
+    write_catalog_cache(filename, satellites, sat_count, source_hash, source_size);
+}
+
+/* one name/line 1/line 2 triple found by the line scanner, still pointing into the file view */
+typedef struct
+{
+    const char *line[3];
+    int len[3];
+    int line_no;
+    const char *error;
+} TleRecord;
+
+typedef struct
+{
+    TleRecord *records;
+    int base; // satellites[] slot of records[0]
+} TleInitJob;
+
+/* record i lands in slot base + i, failures leave a hole that load_tle_data() closes afterwards */
+static void init_tle_records(void *arg, int start, int end)
+{
+    TleInitJob *job = (TleInitJob *)arg;
+    for (int i = start; i < end; i++)
+    {
+        TleRecord *rec = &job->records[i];
+        rec->error = init_satellite_slot(satellites, job->base + i, rec->line[0], rec->len[0], rec->line[1], rec->len[1], rec->line[2], rec->len[2]);
+    }
+}
+
+/* bulk loading of celestial junk from flat files. the scan for record boundaries is serial and cheap, the parsing and
+   sgp4init behind it get spread over the worker pool */
+void load_tle_data(const char *filename)
+{
+    FileView view;
+    if (!open_file_view(filename, &view))
+    {
+        fprintf(stderr, "Failed to open %s\n", filename);
+        return;
+    }
+
+    for (int i = 0; i < sat_count; i++)
+        release_orbit_cache(&satellites[i]); /* slots past sat_count never own one */
+    sat_count = 0;
+    sat_catalog_rev++;
+    if (!ensure_catalog())
+    {
+        close_file_view(&view);
+        return;
+    }
+
+    uint64_t source_hash = hash_bytes(view.data, view.size);
+    if (load_catalog_cache(filename, source_hash, view.size))
+    {
+        sat_count = merge_duplicate_satellites(satellites, sat_count); /* pulls write the cache before merging */
+        sat_catalog_rev++;
+        close_file_view(&view);
+        return;
+    }
+
+    const char *cursor = view.data, *end = view.data + view.size;
+    const char *line0;
+    int len0;
+    int line_no = 0;
+
+    /* Check for custom header to restore TLE Manager state */
+    const char *header_end = cursor;
+    if (next_line(&header_end, end, &line0, &len0) && len0 >= 8 && strncmp(line0, "# EPOCH:", 8) == 0)
+    {
+        cursor = header_end;
+        line_no++;
+    }
+
+    TleRecord *records = NULL;
+    int record_count = 0, record_cap = 0;
+    while (next_line(&cursor, end, &line0, &len0))
+    {
+        line_no++;
+        if (len0 == 0 || line0[0] == '#')
+            continue;
+
+        TleRecord rec = {.line = {line0}, .len = {len0}, .line_no = line_no};
+        if (!next_line(&cursor, end, &rec.line[1], &rec.len[1]) || !next_line(&cursor, end, &rec.line[2], &rec.len[2]))
+            break;
+        line_no += 2;
+
+        if (record_count == record_cap)
+        {
+            int new_cap = record_cap ? record_cap * 2 : 1024;
+            TleRecord *grown = (TleRecord *)realloc(records, sizeof(TleRecord) * new_cap);
+            if (!grown)
+                break;
+            records = grown;
+            record_cap = new_cap;
+        }
+        records[record_count++] = rec;
+    }
+
+    int fits = grow_catalog(satellites, record_count);
+    if (fits > record_count)
+        fits = record_count;
+    TleInitJob job = {records, 0};
+    WorkerPoolRun(init_tle_records, &job, fits, 64);
+
+    /* squeeze out the slots of rejected records, file order stays */
+    int rejected = 0;
+    for (int i = 0; i < record_count; i++)
+    {
+        if (i >= fits)
+            records[i].error = "catalog full";
+        if (records[i].error)
+        {
+            if (++rejected <= 5)
+                fprintf(stderr, "%s:%d: rejected TLE record: %s\n", filename, records[i].line_no, records[i].error);
+            continue;
+        }
+        move_satellite(satellites, sat_count, i);
+        sat_count++;
+    }
+    sat_count = merge_duplicate_satellites(satellites, sat_count);
+    sat_catalog_rev++;
+    save_catalog_cache(filename, source_hash, view.size);
+
+    free(records);
+    close_file_view(&view);
+    if (rejected > 0)
+        fprintf(stderr, "%s: %d TLE records rejected\n", filename, rejected);
+}
+
+/* --- streaming TLE parser for downloads: same record framing as load_tle_data(), but fed whatever chunks the network
+   hands over. records are parsed and sgp4init'ed the moment their third line completes, right into the slots of the
+   staging catalog, so a finished download is a ready catalog and neither the text nor a second copy of the satellites
+   ever sits in memory --- */
+
+#define TLE_STREAM_LINE 160 // longer lines only ever matter for their first 69 columns
+
+struct TleStream
+{
+    char source[256]; // for diagnostics
+    char line[3][TLE_STREAM_LINE];
+    int len[3]; // stored length, capped at TLE_STREAM_LINE
+    int have;   // complete lines of the current record
+    int line_no;
+    int record_line_no;
+    bool in_line; // a started line is waiting for its newline
+    int rejected;
+    TleStaging *staging;
+    int *slots; // staging catalog slots of this stream's satellites, in stream order
+    int count;
+    int capacity;
+};
+
+TleStream *tle_stream_create(const char *source, TleStaging *staging)
+{
+    TleStream *stream = (TleStream *)calloc(1, sizeof(TleStream));
+    if (stream)
+    {
+        strncpy(stream->source, source, sizeof(stream->source) - 1);
+        stream->staging = staging;
+    }
+    return stream;
+}
+
+void tle_stream_free(TleStream *stream)
+{
+    if (!stream)
+        return;
+    free(stream->slots);
+    free(stream);
+}
+
+int tle_stream_count(const TleStream *stream)
+{
+    return stream ? stream->count : 0;
+}
+
+static void tle_stream_record(TleStream *stream)
+{
+    TleStaging *staging = stream->staging;
+    const char *error = NULL;
+    if (stream->count == stream->capacity)
+    {
+        int new_cap = stream->capacity ? stream->capacity * 2 : 256;
+        int *grown = (int *)realloc(stream->slots, sizeof(int) * new_cap);
+        if (grown)
+        {
+            stream->slots = grown;
+            stream->capacity = new_cap;
+        }
+        else
+            error = "out of memory";
+    }
+    /* a rejected record leaves its slot unclaimed, the next one just writes over it */
+    int slot = staging->count;
+    if (!error && (!staging->catalog || grow_catalog(staging->catalog, slot + 1) <= slot))
+        error = "catalog full";
+    if (!error)
+        error = init_satellite_slot(staging->catalog, slot, stream->line[0], stream->len[0], stream->line[1], stream->len[1],
+                                    stream->line[2], stream->len[2]);
+    if (error)
+    {
+        if (++stream->rejected <= 5)
+            fprintf(stderr, "%s:%d: rejected TLE record: %s\n", stream->source, stream->record_line_no, error);
+        return;
+    }
+    staging->count++;
+    stream->slots[stream->count++] = slot;
+}
+
+/* a line of the current record is complete: blank and comment lines between records are skipped like next_line() callers do */
+static void tle_stream_end_line(TleStream *stream)
+{
+    int *len = &stream->len[stream->have];
+    char *line = stream->line[stream->have];
+    if (*len > 0 && line[*len - 1] == '\r')
+        (*len)--;
+    stream->line_no++;
+    stream->in_line = false;
+
+    if (stream->have == 0)
+    {
+        if (*len == 0 || line[0] == '#')
+        {
+            *len = 0;
+            return;
+        }
+        stream->record_line_no = stream->line_no;
+    }
+    if (++stream->have == 3)
+    {
+        tle_stream_record(stream);
+        stream->have = 0;
+        stream->len[0] = stream->len[1] = stream->len[2] = 0;
+    }
+}
+
+void tle_stream_feed(TleStream *stream, const char *data, size_t size)
+{
+    const char *p = data, *end = data + size;
+    while (p < end)
+    {
+        const char *nl = (const char *)memchr(p, '\n', (size_t)(end - p));
+        const char *stop = nl ? nl : end;
+        int *len = &stream->len[stream->have];
+        int room = TLE_STREAM_LINE - *len;
+        int take = (stop - p) < room ? (int)(stop - p) : room;
+        memcpy(stream->line[stream->have] + *len, p, take);
+        *len += take;
+        stream->in_line = true;
+        if (!nl)
+            break;
+        tle_stream_end_line(stream);
+        p = nl + 1;
+    }
+}
+
+/* the body is over: a last line without a newline still counts, a record missing its second or third line doesn't */
+void tle_stream_finish(TleStream *stream)
+{
+    if (stream->in_line)
+        tle_stream_end_line(stream);
+    if (stream->rejected > 0)
+        fprintf(stderr, "%s: %d TLE records rejected\n", stream->source, stream->rejected);
+}
+
+int finish_staged_catalog(TleStaging *staging, TleStream **streams, int count, const char *cache_filename)
+{
+    Satellite *catalog = staging->catalog;
+    int staged = staging->count;
+    if (!catalog || staged == 0)
+        return 0;
+
+    /* where every staged slot has to end up: the streams' slots first, in order, whatever nobody claims after them */
+    int *dest = (int *)malloc(sizeof(int) * staged);
+    if (!dest)
+        return 0;
+    for (int i = 0; i < staged; i++)
+        dest[i] = -1;
+    int kept = 0;
+    for (int i = 0; i < count; i++)
+        for (int j = 0; j < tle_stream_count(streams[i]); j++)
+            dest[streams[i]->slots[j]] = kept++;
+    for (int i = 0, dropped = kept; i < staged; i++)
+        if (dest[i] < 0)
+            dest[i] = dropped++;
+
+    /* in place along the permutation's cycles, every swap puts one satellite where it belongs. staged slots have no
+       orbit cache, so plain swaps are fine */
+    SatHot *hot = catalog_hot(catalog);
+    Satellite tmp;
+    SatHot hot_tmp;
+    for (int i = 0; i < staged; i++)
+    {
+        while (dest[i] != i)
+        {
+            int j = dest[i];
+            tmp = catalog[j];
+            catalog[j] = catalog[i];
+            catalog[i] = tmp;
+            hot_tmp = hot[j];
+            hot[j] = hot[i];
+            hot[i] = hot_tmp;
+            dest[i] = dest[j];
+            dest[j] = j;
+        }
+    }
+    free(dest);
+    staging->count = kept;
+
+    if (cache_filename)
+    {
+        FileView view;
+        if (open_file_view(cache_filename, &view))
+        {
+            uint64_t source_hash = hash_bytes(view.data, view.size);
+            uint64_t source_size = view.size;
+            close_file_view(&view);
+            write_catalog_cache(cache_filename, catalog, kept, source_hash, source_size);
+        }
+    }
+    staging->count = merge_duplicate_satellites(catalog, kept);
+    return staging->count;
+}
+
+/* the "name|line 1|line 2" entries of the config (likely copy-pasted in a hurry, so bad ones are reported and skipped)
+   behind the first count satellites of catalog, returns the new count */
+int append_manual_tles(Satellite *catalog, int count, const AppConfig *config)
+{
+    for (int i = 0; i < config->manual_tle_count; i++)
+    {
+        char temp[512];
+        strcpy(temp, config->manual_tles[i]);
+
+        char *line0 = temp;
+        char *line1 = strchr(line0, '|');
+        if (!line1) continue;
+        *line1 = '\0';
+        line1++;
+
+        char *line2 = strchr(line1, '|');
+        if (!line2) continue;
+        *line2 = '\0';
+        line2++;
+
+        const char *error = (count < grow_catalog(catalog, count + 1)) ? init_satellite_slot(catalog, count, line0, strlen(line0), line1, strlen(line1), line2, strlen(line2))
+                                                     : "catalog full";
+        if (error)
+            fprintf(stderr, "Rejected TLE for '%.24s': %s\n", line0, error);
+        else
+            count++;
+    }
+    return merge_duplicate_satellites(catalog, count); /* a manual TLE of a catalog object wins if it's newer */
+}
+
+void load_manual_tles(AppConfig *config)
+{
+    if (!ensure_catalog())
+        return;
+    sat_count = append_manual_tles(satellites, sat_count, config);
+    sat_catalog_rev++;
+}
+
+/* main sgp4 crank; outputs raw ECI coordinates */
+/* precalculated unix time passed down to prevent excessyear/day conversions */
+Vector3 calculate_position_r(const Satellite *sat, double current_unix, SgpResonance *res)
+{
+    double tsince = (current_unix - sat->epoch_unix) / 60.0;
+
+    double ro[3] = {0};
+    double vo[3] = {0};
+
+    /* sgp4 scribbles all over the elset (dspace even keeps its integrator in there), so crank a scratch copy
+       and keep the resonance bits wherever the caller wants them. the state is only a warm start, results don't depend on it */
+    struct elsetrec rec = sat->satrec;
+    if (res)
+    {
+        rec.atime = res->atime;
+        rec.xli = res->xli;
+        rec.xni = res->xni;
+    }
+    else
+    {
+        rec.atime = 0.0;
+    }
+
+    sgp4(&rec, tsince, ro, vo);
+
+    if (res)
+    {
+        res->atime = rec.atime;
+        res->xli = rec.xli;
+        res->xni = rec.xni;
+    }
+
+    Vector3 pos;
+    pos.x = (float)(ro[0]);
+    pos.y = (float)(ro[2]);
+    pos.z = (float)(-ro[1]);
+
+    return pos;
+}
+
+Vector3 calculate_position(Satellite *sat, double current_unix)
+{
+    return calculate_position_r(sat, current_unix, &sat->resonance);
+}
+
+/* projects 3D orbital space onto a 2D equirectangular map plane */
+void get_map_coordinates(Vector3 pos, double gmst_deg, float earth_offset, float map_w, float map_h, float *out_x, float *out_y)
+{
+    float r = Vector3Length(pos);
+    if (r == 0)
+        r = 0.0001f;
+    float phi = acosf(pos.y / r);
+    float v = phi / PI;
+
+    float theta_sat = atan2f(-pos.z, pos.x);
+    float R_rad = (gmst_deg + earth_offset) * DEG2RAD;
+    float theta_tex = theta_sat - R_rad;
+
+    while (theta_tex > PI)
+        theta_tex -= 2.0f * PI;
+    while (theta_tex < -PI)
+        theta_tex += 2.0f * PI;
+
+    float u = theta_tex / (2.0f * PI) + 0.5f;
+    *out_x = (u - 0.5f) * map_w;
+    *out_y = (v - 0.5f) * map_h;
+}
+
+/* finds where the sat hits the high and low points of its orbit in 2D */
+void get_apsis_2d(Satellite *sat, double current_time, bool is_apoapsis, double gmst_deg, float earth_offset, float map_w, float map_h, Vector2 *out)
+{
+    (void)gmst_deg;
+
+    double current_unix = get_unix_from_epoch(current_time);
+    double delta_time_s = current_unix - sat->epoch_unix;
+
+    double M = fmod(sat->mean_anomaly + sat->mean_motion * delta_time_s, 2.0 * PI);
+    if (M < 0)
+        M += 2.0 * PI;
+
+    double target_M = is_apoapsis ? PI : 0.0;
+    double diff = target_M - M;
+    if (diff < 0)
+        diff += 2.0 * PI;
+
+    double t_target = current_time + (diff / sat->mean_motion) / 86400.0;
+    double t_target_unix = get_unix_from_epoch(t_target);
+    Vector3 pos3d = calculate_position(sat, t_target_unix);
+    double gmst_target = epoch_to_gmst(t_target);
+
+    get_map_coordinates(pos3d, gmst_target, earth_offset, map_w, map_h, &out->x, &out->y);
+}
+
+/* predicts the timestamps for the next perigee and apoapsis */
+void get_apsis_times(Satellite *sat, double current_time, double *out_peri_unix, double *out_apo_unix)
+{
+    double current_unix = get_unix_from_epoch(current_time);
+    double delta_time_s = current_unix - sat->epoch_unix;
+
+    double M = fmod(sat->mean_anomaly + sat->mean_motion * delta_time_s, 2.0 * PI);
+    if (M < 0)
+        M += 2.0 * PI;
+
+    double diff_peri = 0.0 - M;
+    if (diff_peri < 0)
+        diff_peri += 2.0 * PI;
+    double diff_apo = PI - M;
+    if (diff_apo < 0)
+        diff_apo += 2.0 * PI;
+
+    double t_peri = current_time + (diff_peri / sat->mean_motion) / 86400.0;
+    double t_apo = current_time + (diff_apo / sat->mean_motion) / 86400.0;
+
+    *out_peri_unix = get_unix_from_epoch(t_peri);
+    *out_apo_unix = get_unix_from_epoch(t_apo);
+}
+
+/* Calculates cache resolution based on orbital eccentricity */
+int calculate_orbit_cache_resolution(double eccentricity, int active_sat_count, int total_sat_count)
+{
+    (void)active_sat_count;  // unused
+    (void)total_sat_count;   // unused
+    
+    // Low eccentricity
+    if (eccentricity < 0.05)
+        return 180;
+    // Moderate eccentricity
+    if (eccentricity < 0.3)
+        return 270;
+    // High eccentricity
+    return 361;
+}
+
+/* Checks if cached orbit is still valid based on satellite drift */
+bool is_orbit_cache_valid(Satellite *sat, Vector3 current_pos, float drift_threshold_km)
+{
+    if (!sat->orbit_cached)
+        return false;
+    
+    float drift = Vector3Distance(sat->cached_orbit_base_pos, current_pos);
+    return drift < drift_threshold_km;
+}
+
+/* bakes the future orbital path into a vertex buffer so sgp4 isnt re-ran every frame */
+void update_orbit_cache(Satellite *sat, double current_epoch)
+{
+    if (!sat->orbit_cache)
+    {
+        sat->orbit_cache = (Vector3 *)malloc(sizeof(Vector3) * ORBIT_CACHE_SIZE);
+        if (!sat->orbit_cache)
+            return;
+        orbit_cache_count++;
+    }
+    sat->orbit_cache_resolution = calculate_orbit_cache_resolution(sat->eccentricity, 0, sat_count);
+    
+    double period_days = (2.0 * PI / sat->mean_motion) / 86400.0;
+    double time_step = period_days / (sat->orbit_cache_resolution - 1);
+    
+    /* walks forward a whole orbit, on its own copy of the integrator so the frame update doesn't get dragged along */
+    SgpResonance res = sat->resonance;
+    for (int i = 0; i < sat->orbit_cache_resolution; i++)
+    {
+        double t = current_epoch + (i * time_step);
+        double t_unix = get_unix_from_epoch(t);
+        sat->orbit_cache[i] = Vector3Scale(calculate_position_r(sat, t_unix, &res), 1.0f / DRAW_SCALE);
+    }
+    
+    // Track cache validity
+    double current_unix = get_unix_from_epoch(current_epoch);
+    sat->cached_orbit_base_pos = calculate_position(sat, current_unix);
+    sat->cached_orbit_epoch = current_epoch;
+    sat->orbit_cached = true;
+    if (++orbit_cache_generation == 0) /* 0 stays "never uploaded" for the renderer */
+        orbit_cache_generation = 1;
+    sat->orbit_cache_gen = orbit_cache_generation;
+}
+
+/* converts raw orbital data into azimuth/elevation for a specific ground station */
+void get_az_el(Vector3 eci_pos, double gmst_deg, float obs_lat, float obs_lon, float obs_alt, double *az, double *el)
+{
+    double sat_r = Vector3Length(eci_pos);
+    if (sat_r == 0)
+    {
+        *az = 0;
+        *el = -90;
+        return;
+    }
+
+    double sat_lat = asin(eci_pos.y / sat_r);
+    double sat_lon_eci = atan2(-eci_pos.z, eci_pos.x);
+    double theta = (gmst_deg + 0) * DEG2RAD; /* assuming earth_rotation_offset handled befor */
+    double sat_lon_ecef = sat_lon_eci - theta;
+
+    double s_x = sat_r * cos(sat_lat) * cos(sat_lon_ecef);
+    double s_y = sat_r * cos(sat_lat) * sin(sat_lon_ecef);
+    double s_z = sat_r * sin(sat_lat);
+
+    double o_x, o_y, o_z;
+    geodetic_to_ecef(obs_lat, obs_lon, obs_alt, &o_x, &o_y, &o_z);
+
+    double dx = s_x - o_x;
+    double dy = s_y - o_y;
+    double dz = s_z - o_z;
+
+    double lat_rad = obs_lat * DEG2RAD;
     double lon_rad = obs_lon * DEG2RAD;
     double clat = cos(lat_rad);
     double slat = sin(lat_rad);
     double clon = cos(lon_rad);
     double slon = sin(lon_rad);
 
-    double east = -slon * dx + clon * dy;
-    double north = -slat * clon * dx - slat * slon * dy + clat * dz;
-    double up = clat * clon * dx + clat * slon * dy + slat * dz;
+    double east = -slon * dx + clon * dy;
+    double north = -slat * clon * dx - slat * slon * dy + clat * dz;
+    double up = clat * clon * dx + clat * slon * dy + slat * dz;
+
+    *el = atan2(up, sqrt(east * east + north * north)) * RAD2DEG;
+    *az = atan2(east, north) * RAD2DEG;
+    if (*az < 0)
+        *az += 360.0;
+}
+
+/* cheap geometric check whether a satellite can get above the horizon for obs at all during the window, no sgp4 involved.
+   the ground track never leaves |lat| <= inclination (180 - inc when retrograde) and the sat is visible out to the
+   horizon half-angle of its apogee, so an observer further poleward than that never sees it. near-synchronous objects
+   barely drift in longitude, so a GEO sitting on the far side of the planet gets thrown out as well.
+   errs on the side of keeping a satellite, the pass search has the final say. */
+bool can_sat_rise(const Satellite *sat, const Marker *obs, double start_epoch, double window_days)
+{
+    const double R_MIN = 6356.752; /* WGS-84 polar radius, the smallest earth gives the widest horizon */
+
+    double a = sat->semi_major_axis;
+    double e = sat->eccentricity;
+    if (!(a > 0.0) || !(e >= 0.0) || e >= 1.0)
+        return true;
+    double r_apo = a * (1.0 + e);
+    if (r_apo <= R_MIN)
+        return true; /* already underground as far as the mean elements go, let sgp4 sort it out */
+
+    /* slack for mean vs osculating elements, geodetic vs geocentric latitude and stale TLEs */
+    double epoch_age_days = fabs(get_unix_from_epoch(start_epoch) - sat->epoch_unix) / 86400.0;
+    double margin = (1.5 + 0.05 * epoch_age_days) * DEG2RAD;
+
+    double horizon = acos(R_MIN / r_apo);
+    double max_lat = sat->inclination <= PI / 2.0 ? sat->inclination : PI - sat->inclination;
+    double obs_lat = fabs(obs->lat) * DEG2RAD;
+    if (obs_lat > max_lat + horizon + margin)
+        return false;
+
+    /* the longitude check only holds together for prograde, near circular orbits */
+    if (sat->inclination >= PI / 2.0 || e > 0.1)
+        return true;
+
+    /* sub-satellite point sits within inclination of the equator at the mean longitude (plus ~2e of equation of center),
+       and that mean longitude drifts at n - earth rate relative to the ground */
+    double start_unix = get_unix_from_epoch(start_epoch);
+    double mean_lon = sat->raan + sat->arg_perigee + sat->mean_anomaly + sat->mean_motion * (start_unix - sat->epoch_unix);
+    double drift = (sat->mean_motion - EARTH_ROT_RAD_S) * window_days * 86400.0;
+    double half_width = fabs(drift) / 2.0 + 2.5 * e;
+    if (half_width >= PI)
+        return true;
+
+    double center = mean_lon + drift / 2.0 - epoch_to_gmst(start_epoch) * DEG2RAD;
+    double dlon = fmod(center - obs->lon * DEG2RAD, 2.0 * PI);
+    if (dlon > PI)
+        dlon -= 2.0 * PI;
+    if (dlon < -PI)
+        dlon += 2.0 * PI;
+    double closest_dlon = fabs(dlon) - half_width;
+    if (closest_dlon < 0.0)
+        closest_dlon = 0.0;
+
+    double closest = acos(cos(obs_lat) * cos(closest_dlon)) - sat->inclination;
+    return closest <= horizon + margin;
+}
+
+/* qsort callback to keep passes chronological */
+int compare_passes(const void *a, const void *b)
+{
+    const SatPass *p1 = (const SatPass *)a;
+    const SatPass *p2 = (const SatPass *)b;
+    if (p1->aos_epoch < p2->aos_epoch)
+        return -1;
+    if (p1->aos_epoch > p2->aos_epoch)
+        return 1;
+    return 0;
+}
+
+/* per-satellite state while the coarse search sweeps through time */
+typedef struct
+{
+    bool in_pass;
+    double aos_epoch;
+    double max_el_epoch;
+    float max_el;
+} PassScan;
+
+/* a pass as found by the coarse search, before the max elevation gets pinned down */
+typedef struct
+{
+    int sat_idx;
+    double aos_epoch;
+    double los_epoch;
+    double max_el_epoch;
+    float max_el;
+    double max_lo, max_hi; // samples either side of the best coarse sample, the peak is somewhere in between
+} PassEvent;
+
+/* everything one pass search needs, so it can run on any thread without touching passes[] or home_location */
+typedef struct
+{
+    int *targets;
+    int target_count;
+    int skipped_count; // active satellites can_sat_rise() ruled out before the scan
+    double start_epoch;
+    double days;
+    double coarse_step;
+    bool adaptive;
+    Marker obs;
+    double obs_ecef[3]; // the adaptive step measures against the observer's direction from the earth's center
+    double obs_r;
+
+    /* the scan writes one list per chunk, keyed by the chunk's first target so no locking is needed */
+    PassEvent **chunk_events;
+    int *chunk_event_counts;
+
+    SatPass *results;
+    int result_count;
+
+    volatile int sats_done;
+    volatile int sats_scanned; // the rest came straight out of the pass cache
+    volatile int passes_done;
+    volatile int cancel;
+
+    volatile long long scan_calls;
+    volatile long long refine_calls;
+    double elapsed_ms;
+} PassSearch;
+
+bool pass_search_adaptive = true;
+bool pass_search_report = false;
+static PassSearchStats last_pass_stats;
+
+#define PASS_SCAN_CHUNK 16
+/* the scan starts half an hour early so a pass that is already in progress gets its true AOS */
+#define PASS_SCAN_BACKUP (30.0 / 1440.0)
+
+static double get_sat_elevation(const Satellite *sat, double epoch, const Marker *obs, SgpResonance *res)
+{
+    double az, el;
+    get_az_el(calculate_position_r(sat, get_unix_from_epoch(epoch), res), epoch_to_gmst(epoch), obs->lat, obs->lon, obs->alt, &az, &el);
+    return el;
+}
+
+/* binary search for the horizon crossing between a below and an above sample, stepping by 1min is too crunchy for radio work.
+   res is the scan's integrator state, copied so bisecting backwards doesn't reset it */
+static double refine_horizon_crossing(const Satellite *sat, const Marker *obs, const SgpResonance *res, double t_low, double t_high, bool rising, long long *calls)
+{
+    SgpResonance local = *res;
+    *calls += 10;
+    for (int b = 0; b < 10; b++)
+    {
+        double t_mid = (t_low + t_high) / 2.0;
+        bool above = get_sat_elevation(sat, t_mid, obs, &local) >= 0.0;
+        if (above == rising)
+            t_high = t_mid;
+        else
+            t_low = t_mid;
+    }
+    return rising ? t_high : t_low;
+}
+
+/* regula falsi (illinois flavour) on the elevation itself, starting from the two samples the scan already has.
+   usually pins the crossing to well under a second in 3-5 calls where bisection needs 10. returns the end of the
+   final bracket that is above the horizon, same as the bisection */
+static double refine_horizon_crossing_secant(const Satellite *sat, const Marker *obs, const SgpResonance *res, double t_a, double el_a,
+                                             double t_b, double el_b, long long *calls)
+{
+    const double tolerance = 0.05 / 86400.0;
+    SgpResonance local = *res;
+    int last_side = 0;
+    for (int i = 0; i < 16 && t_b - t_a > tolerance; i++)
+    {
+        double t = t_b - el_b * (t_b - t_a) / (el_b - el_a);
+        if (!(t > t_a && t < t_b))
+            t = (t_a + t_b) / 2.0;
+        double el = get_sat_elevation(sat, t, obs, &local);
+        (*calls)++;
+        if (fabs(el) < 1e-4)
+            return t;
+
+        /* halving the stale end's elevation stops the bracket from only ever closing in from one side */
+        if ((el < 0.0) == (el_a < 0.0))
+        {
+            t_a = t;
+            el_a = el;
+            if (last_side == -1)
+                el_b /= 2.0;
+            last_side = -1;
+        }
+        else
+        {
+            t_b = t;
+            el_b = el;
+            if (last_side == 1)
+                el_a /= 2.0;
+            last_side = 1;
+        }
+    }
+    return el_a >= 0.0 ? t_a : t_b;
+}
+
+static void push_pass_event(PassEvent **list, int *count, int *capacity, int sat_idx, double aos, double los, float max_el, double max_el_epoch,
+                            double max_lo, double max_hi)
+{
+    if (*count >= *capacity)
+    {
+        int new_cap = *capacity ? *capacity * 2 : 16;
+        PassEvent *grown = (PassEvent *)realloc(*list, sizeof(PassEvent) * new_cap);
+        if (!grown)
+            return;
+        *list = grown;
+        *capacity = new_cap;
+    }
+    (*list)[(*count)++] = (PassEvent){sat_idx, aos, los, max_el_epoch, max_el, max_lo, max_hi};
+}
+
+typedef struct
+{
+    PassSearch *search;
+    int base;
+} PassScanJob;
+
+/* coarse search over one chunk of targets; the chunk gets its own propagation batch so chunks run side by side */
+static void scan_pass_chunk(void *arg, int start, int end)
+{
+    PassScanJob *job = (PassScanJob *)arg;
+    PassSearch *search = job->search;
+    if (search->cancel)
+        return;
+    start += job->base;
+    end += job->base;
+
+    PassEvent *events = NULL;
+    int event_count = 0, event_cap = 0;
+    long long calls = 0;
+
+    SatBatch batch;
+    sat_batch_init(&batch);
+    sat_batch_build(&batch, search->targets + start, end - start);
+    Vector3 *pos = (Vector3 *)malloc(sizeof(Vector3) * (batch.count > 0 ? batch.count : 1));
+    PassScan *scan = (PassScan *)calloc(batch.count > 0 ? batch.count : 1, sizeof(PassScan));
+
+    double coarse_step = search->coarse_step;
+    double backup = PASS_SCAN_BACKUP;
+    double t = search->start_epoch - backup;
+    int steps = (int)((search->days + backup) / coarse_step);
+
+    for (int i = 0; i < steps && !search->cancel; i++)
+    {
+        double t_unix = get_unix_from_epoch(t);
+        double gmst = epoch_to_gmst(t);
+        propagate_batch(&batch, t_unix, pos, batch.count);
+        calls += batch.count;
+
+        for (int lane = 0; lane < batch.count; lane++)
+        {
+            const Satellite *current_sat = &satellites[batch.sat_index[lane]];
+            PassScan *ps = &scan[lane];
+            double az, el;
+            get_az_el(pos[lane], gmst, search->obs.lat, search->obs.lon, search->obs.alt, &az, &el);
+
+            if (el >= 0.0)
+            {
+                if (!ps->in_pass)
+                {
+                    ps->in_pass = true;
+                    ps->aos_epoch = refine_horizon_crossing(current_sat, &search->obs, &batch.resonance[lane], t - coarse_step, t, true, &calls);
+                    ps->max_el = el;
+                    ps->max_el_epoch = t;
+                }
+                if (el > ps->max_el)
+                {
+                    ps->max_el = el;
+                    ps->max_el_epoch = t;
+                }
+            }
+            else if (ps->in_pass)
+            {
+                ps->in_pass = false;
+                double los = refine_horizon_crossing(current_sat, &search->obs, &batch.resonance[lane], t - coarse_step, t, false, &calls);
+                /* passes that were already over before start_epoch only showed up because of the backup */
+                if (los >= search->start_epoch)
+                    push_pass_event(&events, &event_count, &event_cap, batch.sat_index[lane], ps->aos_epoch, los, ps->max_el, ps->max_el_epoch,
+                                    ps->max_el_epoch - coarse_step, ps->max_el_epoch + coarse_step);
+            }
+        }
+        t += coarse_step;
+    }
+
+    /* whatever is still above the horizon when the window closes */
+    for (int lane = 0; lane < batch.count; lane++)
+    {
+        if (scan[lane].in_pass)
+            push_pass_event(&events, &event_count, &event_cap, batch.sat_index[lane], scan[lane].aos_epoch, t, scan[lane].max_el, scan[lane].max_el_epoch,
+                            scan[lane].max_el_epoch - coarse_step, scan[lane].max_el_epoch + coarse_step);
+    }
 
-    *el = atan2(up, sqrt(east * east + north * north)) * RAD2DEG;
-    *az = atan2(east, north) * RAD2DEG;
-    if (*az < 0)
-        *az += 360.0;
+    free(scan);
+    free(pos);
+    sat_batch_free(&batch);
+
+    search->chunk_events[start] = events;
+    search->chunk_event_counts[start] = event_count;
+    __sync_fetch_and_add(&search->scan_calls, calls);
+    __sync_fetch_and_add(&search->sats_done, end - start);
 }
 
-/* qsort callback to keep passes chronological */
-int compare_passes(const void *a, const void *b)
+/* upper bound on how fast the satellite's direction from the earth's center sweeps across the ground (rad/s).
+   that's the orbit's angular velocity (fastest at perigee, slowest at apogee) minus earth rotation, tilted by the
+   inclination. the second part bounds how fast the horizon circle itself grows or shrinks as the radius changes */
+static double max_horizon_closing_rate(const Satellite *sat, double obs_r)
 {
-    const SatPass *p1 = (const SatPass *)a;
-    const SatPass *p2 = (const SatPass *)b;
+    double n = sat->mean_motion;
+    double e = sat->eccentricity;
+    double k = pow(1.0 - e * e, 1.5);
+    double fast = n * (1.0 + e) * (1.0 + e) / k;
+    double slow = n * (1.0 - e) * (1.0 - e) / k;
+    double ci = cos(sat->inclination);
+    double w = EARTH_ROT_RAD_S;
+    double ground = fmax(sqrt(fast * fast + w * w - 2.0 * fast * w * ci), sqrt(slow * slow + w * w - 2.0 * slow * w * ci));
+
+    double horizon = 0.0;
+    double r_peri = sat->semi_major_axis * (1.0 - e);
+    double p = sat->semi_major_axis * (1.0 - e * e);
+    if (r_peri > obs_r * 1.001 && p > 0.0)
+        horizon = obs_r / (r_peri * sqrt(r_peri * r_peri - obs_r * obs_r)) * e * sqrt(MU / p);
+
+    /* sgp4 perturbations on top of the two body picture */
+    return 1.05 * (ground + horizon) + 1e-7;
+}
+
+/* one adaptive sample: the elevation for the crossing logic, plus how far (as a geocentric angle) the satellite is
+   from the edge of the observer's horizon circle at its current radius */
+static double sample_pass_geometry(const Satellite *sat, double epoch, const PassSearch *search, SgpResonance *res, double *horizon_gap)
+{
+    Vector3 pos = calculate_position_r(sat, get_unix_from_epoch(epoch), res);
+    double gmst = epoch_to_gmst(epoch);
+    double az, el;
+    get_az_el(pos, gmst, search->obs.lat, search->obs.lon, search->obs.alt, &az, &el);
+
+    double theta = gmst * DEG2RAD;
+    double cos_t = cos(theta), sin_t = sin(theta);
+    double s_x = pos.x * cos_t - pos.z * sin_t;
+    double s_y = -pos.x * sin_t - pos.z * cos_t;
+    double s_z = pos.y;
+    double r = sqrt(s_x * s_x + s_y * s_y + s_z * s_z);
+    if (r <= 0.0)
+    {
+        *horizon_gap = 0.0;
+        return el;
+    }
+
+    double cos_c = (s_x * search->obs_ecef[0] + s_y * search->obs_ecef[1] + s_z * search->obs_ecef[2]) / (r * search->obs_r);
+    double ratio = search->obs_r / r;
+    double central = acos(fmax(-1.0, fmin(1.0, cos_c)));
+    double horizon = ratio < 1.0 ? acos(ratio) : 0.0;
+    *horizon_gap = fabs(central - horizon);
+    return el;
+}
+
+/* the step can't be longer than the time the satellite needs to reach the horizon circle at the bounded rate.
+   the slack covers geodetic vs geocentric up, deep below the horizon that's a big step and right next to it a small one */
+#define PASS_ADAPTIVE_SLACK (0.5 * DEG2RAD)
+#define PASS_ADAPTIVE_MIN_STEP (20.0 / 86400.0)
+#define PASS_ADAPTIVE_MAX_STEP (60.0 / 1440.0)
+
+static double adaptive_pass_step(double horizon_gap, double rate)
+{
+    double step = (horizon_gap - PASS_ADAPTIVE_SLACK) / rate / 86400.0;
+    if (step < PASS_ADAPTIVE_MIN_STEP)
+        return PASS_ADAPTIVE_MIN_STEP;
+    if (step > PASS_ADAPTIVE_MAX_STEP)
+        return PASS_ADAPTIVE_MAX_STEP;
+    return step;
+}
+
+/* pins down the real max elevation with a golden section search between the samples either side of the coarse peak,
+   then collapses the bracket so refining the same event again is free */
+static int refine_pass_peak(PassEvent *ev, const Marker *obs)
+{
+    double a = fmax(ev->max_lo, ev->aos_epoch);
+    double b = fmin(ev->max_hi, ev->los_epoch);
+    ev->max_lo = ev->max_hi = ev->max_el_epoch;
+    if (b <= a)
+        return 0;
+
+    const Satellite *sat = &satellites[ev->sat_idx];
+    const double golden = 0.6180339887498949;
+    SgpResonance res = {0};
+    double c = b - golden * (b - a), d = a + golden * (b - a);
+    double fc = get_sat_elevation(sat, c, obs, &res);
+    double fd = get_sat_elevation(sat, d, obs, &res);
+    int calls = 2;
+    while (b - a > 1.0 / 86400.0 && calls < 48)
+    {
+        if (fc > fd)
+        {
+            b = d;
+            d = c;
+            fd = fc;
+            c = b - golden * (b - a);
+            fc = get_sat_elevation(sat, c, obs, &res);
+        }
+        else
+        {
+            a = c;
+            c = d;
+            fc = fd;
+            d = a + golden * (b - a);
+            fd = get_sat_elevation(sat, d, obs, &res);
+        }
+        calls++;
+    }
+
+    double best = fc > fd ? fc : fd;
+    if (best > ev->max_el)
+    {
+        ev->max_el = (float)best;
+        ev->max_el_epoch = fc > fd ? c : d;
+        ev->max_lo = ev->max_hi = ev->max_el_epoch;
+    }
+    return calls;
+}
+
+/* walks one satellite from t_from to t_to with the adaptive step, appending every pass that ends after not_before.
+   *open_tail says whether the last pass was cut off by t_to rather than by a real LOS. false if cancelled halfway */
+static bool scan_sat_adaptive(PassSearch *search, int sat_idx, double t_from, double t_to, double not_before, PassEvent **events,
+                              int *count, int *cap, long long *calls, bool *open_tail)
+{
+    const Satellite *sat = &satellites[sat_idx];
+    SgpResonance res = {0};
+    double rate = max_horizon_closing_rate(sat, search->obs_r);
+
+    double t = t_from, gap;
+    double el = sample_pass_geometry(sat, t, search, &res, &gap);
+    (*calls)++;
+
+    bool in_pass = el >= 0.0;
+    double aos = t, max_el_epoch = t;
+    double max_lo = t, max_hi = t;
+    bool max_hi_pending = in_pass;
+    float max_el = (float)el;
+
+    while (t < t_to)
+    {
+        if (search->cancel)
+            return false;
+        double t_next = t + adaptive_pass_step(gap, rate);
+        if (t_next > t_to)
+            t_next = t_to;
+        double next_gap;
+        double el_next = sample_pass_geometry(sat, t_next, search, &res, &next_gap);
+        (*calls)++;
+        if (max_hi_pending)
+        {
+            max_hi = t_next;
+            max_hi_pending = false;
+        }
+
+        if (!in_pass && el_next >= 0.0)
+        {
+            in_pass = true;
+            aos = refine_horizon_crossing_secant(sat, &search->obs, &res, t, el, t_next, el_next, calls);
+            max_el = (float)el_next;
+            max_el_epoch = t_next;
+            max_lo = aos;
+            max_hi_pending = true;
+        }
+        else if (in_pass && el_next < 0.0)
+        {
+            in_pass = false;
+            double los = refine_horizon_crossing_secant(sat, &search->obs, &res, t, el, t_next, el_next, calls);
+            if (los >= not_before)
+                push_pass_event(events, count, cap, sat_idx, aos, los, max_el, max_el_epoch, max_lo, max_hi);
+        }
+        else if (in_pass && el_next > max_el)
+        {
+            max_el = (float)el_next;
+            max_el_epoch = t_next;
+            max_lo = t;
+            max_hi_pending = true;
+        }
+
+        t = t_next;
+        el = el_next;
+        gap = next_gap;
+    }
+
+    *open_tail = in_pass;
+    if (in_pass)
+        push_pass_event(events, count, cap, sat_idx, aos, t, max_el, max_el_epoch, max_lo, max_hi_pending ? t : max_hi);
+    return true;
+}
+
+/* per-satellite memory of the adaptive search, so a new search only scans what it hasn't seen yet. an entry is good for
+   one TLE (norad id + epoch) and one observer; is_active doesn't matter, so toggling satellites only scans the new ones */
+typedef struct
+{
+    bool valid;
+    char norad_id[6];
+    double tle_epoch_unix;
+    double mean_motion;
+    float obs_lat, obs_lon, obs_alt;
+    double from_epoch;  // start_epoch of the search that began this entry, earlier starts need a rescan
+    double until_epoch; // scanned up to here
+    bool open_tail;     // last pass runs past until_epoch, its LOS is just the window edge
+    PassEvent *events;  // chronological, max elevation already refined
+    int count;
+    int capacity;
+} PassCacheEntry;
+
+static PassCacheEntry *pass_cache = NULL; // indexed by satellites[] slot
+static int pass_cache_size = 0;
+static unsigned int pass_cache_rev = 0; // sat_catalog_rev the slots belong to
+
+static size_t pass_cache_memory_bytes(void)
+{
+    size_t bytes = (size_t)pass_cache_size * sizeof(PassCacheEntry);
+    for (int i = 0; i < pass_cache_size; i++)
+        bytes += (size_t)pass_cache[i].capacity * sizeof(PassEvent);
+    return bytes;
+}
+
+/* the catalog got reloaded or swapped: entries move to wherever their satellite's catalog number is now */
+static void rekey_pass_cache(void)
+{
+    PassCacheEntry *cache = (sat_count > 0) ? (PassCacheEntry *)calloc(sat_count, sizeof(PassCacheEntry)) : NULL;
+    for (int i = 0; i < pass_cache_size; i++)
+    {
+        int slot = (cache && pass_cache[i].valid) ? find_satellite_slot(norad_number(pass_cache[i].norad_id)) : -1;
+        if (slot >= 0 && !cache[slot].valid)
+            cache[slot] = pass_cache[i];
+        else
+            free(pass_cache[i].events);
+    }
+    free(pass_cache);
+    pass_cache = cache;
+    pass_cache_size = cache ? sat_count : 0;
+    pass_cache_rev = sat_catalog_rev;
+}
+
+static bool pass_cache_matches(const PassCacheEntry *entry, const Satellite *sat, const PassSearch *search)
+{
+    return entry->valid && strncmp(entry->norad_id, sat->norad_id, sizeof(entry->norad_id)) == 0 && entry->tle_epoch_unix == sat->epoch_unix &&
+           entry->mean_motion == sat->mean_motion && entry->obs_lat == search->obs.lat && entry->obs_lon == search->obs.lon &&
+           entry->obs_alt == search->obs.alt && search->start_epoch >= entry->from_epoch && search->start_epoch <= entry->until_epoch;
+}
+
+/* brings one satellite's cache entry up to date for the search window: drops passes that are over, scans whatever
+   lies past the end of what's cached. worker threads only ever touch their own satellites' entries, and a cancelled
+   scan leaves the entry as it was */
+static bool update_pass_cache(PassSearch *search, int sat_idx, long long *calls, int *scanned)
+{
+    const Satellite *sat = &satellites[sat_idx];
+    PassCacheEntry *entry = &pass_cache[sat_idx];
+    double t_end = search->start_epoch + search->days;
+
+    bool reuse = pass_cache_matches(entry, sat, search);
+    if (reuse && entry->until_epoch >= t_end)
+        return true;
+
+    int keep_from = 0, keep_to = 0;
+    double t_from = search->start_epoch - PASS_SCAN_BACKUP;
+    if (reuse)
+    {
+        keep_to = entry->count;
+        t_from = entry->until_epoch;
+        /* a pass cut off by the old window edge gets found again, properly this time */
+        if (entry->open_tail && keep_to > 0)
+        {
+            keep_to--;
+            t_from = entry->events[keep_to].aos_epoch - 1.0 / 1440.0;
+        }
+        while (keep_from < keep_to && entry->events[keep_from].los_epoch < search->start_epoch)
+            keep_from++;
+    }
+
+    PassEvent *fresh = NULL;
+    int fresh_count = 0, fresh_cap = 0;
+    bool open_tail = false;
+    (*scanned)++;
+    if (!scan_sat_adaptive(search, sat_idx, t_from, t_end, search->start_epoch, &fresh, &fresh_count, &fresh_cap, calls, &open_tail))
+    {
+        free(fresh);
+        return false;
+    }
+    long long refine_calls = 0;
+    for (int i = 0; i < fresh_count; i++)
+        refine_calls += refine_pass_peak(&fresh[i], &search->obs);
+    __sync_fetch_and_add(&search->refine_calls, refine_calls);
+
+    if (!reuse)
+    {
+        memcpy(entry->norad_id, sat->norad_id, sizeof(entry->norad_id));
+        entry->tle_epoch_unix = sat->epoch_unix;
+        entry->mean_motion = sat->mean_motion;
+        entry->obs_lat = search->obs.lat;
+        entry->obs_lon = search->obs.lon;
+        entry->obs_alt = search->obs.alt;
+        entry->from_epoch = search->start_epoch;
+    }
+
+    /* expired passes go off the front, the new tail goes on the back */
+    entry->count = keep_to - keep_from;
+    if (keep_from > 0)
+        memmove(entry->events, entry->events + keep_from, sizeof(PassEvent) * entry->count);
+    for (int i = 0; i < fresh_count; i++)
+        push_pass_event(&entry->events, &entry->count, &entry->capacity, fresh[i].sat_idx, fresh[i].aos_epoch, fresh[i].los_epoch, fresh[i].max_el,
+                        fresh[i].max_el_epoch, fresh[i].max_lo, fresh[i].max_hi);
+    free(fresh);
+
+    entry->valid = true;
+    entry->until_epoch = t_end;
+    entry->open_tail = open_tail;
+    return true;
+}
+
+/* adaptive search over one chunk of targets. every satellite walks its own timeline, so this goes through the scalar
+   propagator instead of a batch; the far fewer steps more than make up for it. results come out of the pass cache */
+static void scan_pass_chunk_adaptive(void *arg, int start, int end)
+{
+    PassScanJob *job = (PassScanJob *)arg;
+    PassSearch *search = job->search;
+    if (search->cancel)
+        return;
+    start += job->base;
+    end += job->base;
+
+    PassEvent *events = NULL;
+    int event_count = 0, event_cap = 0;
+    long long calls = 0;
+    int scanned = 0;
+    double t_end = search->start_epoch + search->days;
+
+    for (int k = start; k < end && !search->cancel; k++)
+    {
+        int sat_idx = search->targets[k];
+        if (!update_pass_cache(search, sat_idx, &calls, &scanned))
+            break;
+
+        const PassCacheEntry *entry = &pass_cache[sat_idx];
+        for (int i = 0; i < entry->count; i++)
+        {
+            const PassEvent *ev = &entry->events[i];
+            if (ev->los_epoch < search->start_epoch || ev->aos_epoch > t_end)
+                continue;
+            /* a pass the longer cached window saw through to its LOS still ends at this window's edge */
+            double los = ev->los_epoch > t_end ? t_end : ev->los_epoch;
+            push_pass_event(&events, &event_count, &event_cap, sat_idx, ev->aos_epoch, los, ev->max_el, ev->max_el_epoch, ev->max_lo, ev->max_hi);
+        }
+    }
+
+    search->chunk_events[start] = events;
+    search->chunk_event_counts[start] = event_count;
+    __sync_fetch_and_add(&search->scan_calls, calls);
+    __sync_fetch_and_add(&search->sats_scanned, scanned);
+    __sync_fetch_and_add(&search->sats_done, end - start);
+}
+
+/* the polar plot path is left for GetPassPath(), most passes in a long list never get looked at */
+static int finish_pass(SatPass *pass, const PassEvent *ev, const Marker *obs)
+{
+    PassEvent refined = *ev;
+    int calls = refine_pass_peak(&refined, obs);
+    pass->sat = &satellites[refined.sat_idx];
+    pass->aos_epoch = refined.aos_epoch;
+    pass->los_epoch = refined.los_epoch;
+    pass->max_el = refined.max_el;
+    pass->max_el_epoch = refined.max_el_epoch;
+    pass->path_offset = -1;
+    pass->num_pts = 0;
+    return calls;
+}
+
+typedef struct
+{
+    PassSearch *search;
+    const PassEvent *events;
+} PassRefineJob;
+
+static void refine_pass_chunk(void *arg, int start, int end)
+{
+    PassRefineJob *job = (PassRefineJob *)arg;
+    long long calls = 0;
+    for (int i = start; i < end && !job->search->cancel; i++)
+        calls += finish_pass(&job->search->results[i], &job->events[i], &job->search->obs);
+    __sync_fetch_and_add(&job->search->refine_calls, calls);
+    __sync_fetch_and_add(&job->search->passes_done, end - start);
+}
+
+static int compare_pass_events(const void *a, const void *b)
+{
+    const PassEvent *p1 = (const PassEvent *)a;
+    const PassEvent *p2 = (const PassEvent *)b;
     if (p1->aos_epoch < p2->aos_epoch)
         return -1;
     if (p1->aos_epoch > p2->aos_epoch)
         return 1;
-    return 0;
+    return p1->sat_idx - p2->sat_idx;
 }
 
-/* heavy lifting for pass prediction; brute force search with binary search refinement */
-void CalculatePasses(Satellite *sat, double start_epoch)
+static PassSearch *create_pass_search(Satellite *sat, double start_epoch)
 {
-    num_passes = 0;
-    last_pass_calc_sat = sat;
+    PassSearch *search = (PassSearch *)calloc(1, sizeof(PassSearch));
+    if (!search)
+        return NULL;
+
+    search->start_epoch = start_epoch;
+    search->days = sat ? pass_search_days_targeted : pass_search_days;
+    search->coarse_step = sat ? (1.0 / 1440.0) : (4.0 / 1440.0);
+    search->adaptive = pass_search_adaptive;
+    search->obs = home_location;
+    geodetic_to_ecef(search->obs.lat, search->obs.lon, search->obs.alt, &search->obs_ecef[0], &search->obs_ecef[1], &search->obs_ecef[2]);
+    search->obs_r = sqrt(search->obs_ecef[0] * search->obs_ecef[0] + search->obs_ecef[1] * search->obs_ecef[1] + search->obs_ecef[2] * search->obs_ecef[2]);
+
+    int n = sat_count > 0 ? sat_count : 1;
+    search->targets = (int *)malloc(sizeof(int) * n);
+    search->chunk_events = (PassEvent **)calloc(n, sizeof(PassEvent *));
+    search->chunk_event_counts = (int *)calloc(n, sizeof(int));
+    if (!search->targets || !search->chunk_events || !search->chunk_event_counts)
+    {
+        fprintf(stderr, "Failed to allocate pass search for %d satellites\n", n);
+        free(search->targets);
+        free(search->chunk_events);
+        free(search->chunk_event_counts);
+        free(search);
+        return NULL;
+    }
 
-    int target_count = sat ? 1 : sat_count;
-    int max_days = sat ? 3 : 1;
-    double coarse_step = sat ? (1.0 / 1440.0) : (4.0 / 1440.0);
+    if (search->adaptive && pass_cache_rev != sat_catalog_rev)
+        rekey_pass_cache();
+    if (search->adaptive && pass_cache_size < sat_count)
+    {
+        PassCacheEntry *grown = (PassCacheEntry *)realloc(pass_cache, sizeof(PassCacheEntry) * sat_count);
+        if (!grown)
+        {
+            fprintf(stderr, "Failed to grow the pass cache, falling back to the fixed step search\n");
+            search->adaptive = false;
+        }
+        else
+        {
+            memset(grown + pass_cache_size, 0, sizeof(PassCacheEntry) * (sat_count - pass_cache_size));
+            pass_cache = grown;
+            pass_cache_size = sat_count;
+        }
+    }
 
-    for (int s = 0; s < target_count; s++)
+    /* anything that geometrically can't clear the horizon never makes it into a batch */
+    double window_start = start_epoch - PASS_SCAN_BACKUP;
+    double window_days = search->days + PASS_SCAN_BACKUP;
+    int first = sat ? (int)(sat - satellites) : 0;
+    int last = sat ? first + 1 : sat_count;
+    for (int s = first; s < last; s++)
     {
-        Satellite *current_sat = sat ? sat : &satellites[s];
-        if (!current_sat || !current_sat->is_active)
+        if (!sat_hot[s].is_active)
             continue;
+        if (can_sat_rise(&satellites[s], &search->obs, window_start, window_days))
+            search->targets[search->target_count++] = s;
+        else
+            search->skipped_count++;
+    }
+    return search;
+}
 
-        double t = start_epoch;
-        double t_unix = get_unix_from_epoch(t);
-        double gmst = epoch_to_gmst(t);
-        double az, el;
+static void free_pass_search(PassSearch *search)
+{
+    if (!search)
+        return;
+    for (int i = 0; i < search->target_count; i++)
+        free(search->chunk_events[i]);
+    free(search->chunk_events);
+    free(search->chunk_event_counts);
+    free(search->targets);
+    free(search->results);
+    free(search);
+}
+
+static double pass_clock_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+/* heavy lifting for pass prediction; targets are scanned in chunks on the worker pool (adaptive: each satellite on its
+   own timeline, topping up its pass cache; fixed: each chunk steps its satellites through time as one propagation batch),
+   then every pass gets its max elevation refined. safe to run off the main thread. */
+static void run_pass_search(PassSearch *search)
+{
+    double started = pass_clock_ms();
+    WorkerJob scan = search->adaptive ? scan_pass_chunk_adaptive : scan_pass_chunk;
+
+    /* handed to the pool a round at a time so the frame update gets a look in between,
+       otherwise it would find the pool busy and propagate on one thread until we're done */
+    int round = WorkerPoolThreadCount() * PASS_SCAN_CHUNK * 4;
+    for (int base = 0; base < search->target_count && !search->cancel; base += round)
+    {
+        PassScanJob job = {search, base};
+        int n = search->target_count - base < round ? search->target_count - base : round;
+        WorkerPoolRun(scan, &job, n, PASS_SCAN_CHUNK);
+    }
+    if (search->cancel)
+        return;
 
-        get_az_el(calculate_position(current_sat, t_unix), gmst, home_location.lat, home_location.lon, home_location.alt, &az, &el);
+    int total = 0;
+    for (int i = 0; i < search->target_count; i++)
+        total += search->chunk_event_counts[i];
 
-        /* back up if happens to already be in a pass to catch the true start */
-        if (el > 0)
+    PassEvent *events = (PassEvent *)malloc(sizeof(PassEvent) * (total > 0 ? total : 1));
+    if (!events)
+        return;
+    int n = 0;
+    for (int i = 0; i < search->target_count; i++)
+    {
+        if (search->chunk_event_counts[i] > 0)
         {
-            for (int i = 0; i < 30 && el > 0; i++)
-            {
-                t -= (1.0 / 1440.0);
-                t_unix = get_unix_from_epoch(t);
-                gmst = epoch_to_gmst(t);
-                get_az_el(calculate_position(current_sat, t_unix), gmst, home_location.lat, home_location.lon, home_location.alt, &az, &el);
-            }
+            memcpy(events + n, search->chunk_events[i], sizeof(PassEvent) * search->chunk_event_counts[i]);
+            n += search->chunk_event_counts[i];
         }
+    }
 
-        bool in_pass = false;
-        SatPass current_pass = {0};
-        current_pass.sat = current_sat;
+    /* make sure the list actually makes sense chronologically */
+    qsort(events, n, sizeof(PassEvent), compare_pass_events);
 
-        int steps = (max_days * 1440) / (coarse_step * 1440.0);
-        for (int i = 0; i < steps && num_passes < MAX_PASSES; i++)
-        {
-            t_unix = get_unix_from_epoch(t);
-            gmst = epoch_to_gmst(t);
-            get_az_el(calculate_position(current_sat, t_unix), gmst, home_location.lat, home_location.lon, home_location.alt, &az, &el);
+    search->results = (SatPass *)malloc(sizeof(SatPass) * (n > 0 ? n : 1));
+    if (search->results)
+    {
+        PassRefineJob job = {search, events};
+        WorkerPoolRun(refine_pass_chunk, &job, n, 64);
+        search->result_count = n;
+    }
+    free(events);
+    search->elapsed_ms = pass_clock_ms() - started;
+}
 
-            if (el >= 0.0)
-            {
-                if (!in_pass)
-                {
-                    in_pass = true;
-                    /* binary search to find exact AOS because stepping by 1min is too crunchy for radio work */
-                    double t_low = t - coarse_step;
-                    double t_high = t;
-                    for (int b = 0; b < 10; b++)
-                    {
-                        double t_mid = (t_low + t_high) / 2.0;
-                        double mid_unix = get_unix_from_epoch(t_mid);
-                        double mid_gmst = epoch_to_gmst(t_mid);
-                        double mid_az, mid_el;
-                        get_az_el(calculate_position(current_sat, mid_unix), mid_gmst, home_location.lat, home_location.lon, home_location.alt, &mid_az, &mid_el);
-                        if (mid_el >= 0.0)
-                            t_high = t_mid;
-                        else
-                            t_low = t_mid;
-                    }
+/* copies finished results into the shared passes[] table, main thread only */
+static void publish_pass_search(PassSearch *search, Satellite *sat)
+{
+    last_pass_stats = (PassSearchStats){
+        .candidates = search->target_count + search->skipped_count,
+        .skipped = search->skipped_count,
+        .cached = search->adaptive ? search->target_count - search->sats_scanned : 0,
+        .passes = search->result_count,
+        .scan_calls = search->scan_calls,
+        .refine_calls = search->refine_calls,
+        .elapsed_ms = search->elapsed_ms,
+        .adaptive = search->adaptive,
+    };
+    if (pass_search_report)
+    {
+        printf("Pass search (%s, %s): %d sats (%d skipped, %d cached), %d passes, %lld SGP4 calls + %lld max el refine, %.1f ms\n",
+               search->adaptive ? "adaptive" : "fixed step", sat ? sat->name : "all", search->target_count, search->skipped_count,
+               search->adaptive ? search->target_count - search->sats_scanned : 0, search->result_count, search->scan_calls, search->refine_calls, search->elapsed_ms);
+    }
 
-                    current_pass.aos_epoch = t_high;
-                    current_pass.max_el = el;
-                    current_pass.max_el_epoch = t;
-                }
-                if (el > current_pass.max_el)
-                {
-                    current_pass.max_el = el;
-                    current_pass.max_el_epoch = t;
-                }
-            }
-            else
-            {
-                if (in_pass)
-                {
-                    in_pass = false;
-                    /* binary search to find exact LOS crossing */
-                    double t_low = t - coarse_step;
-                    double t_high = t;
-                    for (int b = 0; b < 10; b++)
-                    {
-                        double t_mid = (t_low + t_high) / 2.0;
-                        double mid_unix = get_unix_from_epoch(t_mid);
-                        double mid_gmst = epoch_to_gmst(t_mid);
-                        double mid_az, mid_el;
-                        get_az_el(calculate_position(current_sat, mid_unix), mid_gmst, home_location.lat, home_location.lon, home_location.alt, &mid_az, &mid_el);
-                        if (mid_el < 0.0)
-                            t_high = t_mid;
-                        else
-                            t_low = t_mid;
-                    }
+    /* the search's result list simply becomes passes[], nothing holds on to the old one past this frame */
+    free(passes);
+    passes = search->results;
+    num_passes = search->results ? search->result_count : 0;
+    search->results = NULL;
+    last_pass_calc_sat = sat;
+    pass_obs = search->obs;
+    pass_path_used = 0;
+}
 
-                    current_pass.los_epoch = t_low;
-
-                    current_pass.num_pts = 0;
-                    double step = (current_pass.los_epoch - current_pass.aos_epoch) / 399.0;
-                    if (step > 0)
-                    {
-                        current_pass.max_el = -90.0f; /* reset to find true max during high-res pass */
-                        for (int k = 0; k < 400; k++)
-                        {
-                            double pt = current_pass.aos_epoch + k * step;
-                            double pt_unix = get_unix_from_epoch(pt);
-                            double p_gmst = epoch_to_gmst(pt);
-                            double p_az, p_el;
-                            get_az_el(calculate_position(current_sat, pt_unix), p_gmst, home_location.lat, home_location.lon, home_location.alt, &p_az, &p_el);
-                            current_pass.path_pts[current_pass.num_pts++] = (Vector2){(float)p_az, (float)p_el};
-                            
-                            /* ensure max elevation is pinpointed */
-                            if (p_el > current_pass.max_el)
-                            {
-                                current_pass.max_el = (float)p_el;
-                                current_pass.max_el_epoch = pt;
-                            }
-                        }
-                    }
-                    passes[num_passes++] = current_pass;
-                    current_pass = (SatPass){0};
-                    current_pass.sat = current_sat;
-                }
-            }
-            t += coarse_step;
+/* the polar plot path for a pass, resampled at PASS_PATH_POINTS into the shared arena the first time it's asked for */
+const Vector2 *GetPassPath(SatPass *pass)
+{
+    if (pass->path_offset >= 0)
+        return pass_path_arena + pass->path_offset;
+
+    if (pass_path_used + PASS_PATH_POINTS > pass_path_capacity)
+    {
+        int new_cap = pass_path_capacity ? pass_path_capacity * 2 : PASS_PATH_POINTS * 16;
+        while (new_cap < pass_path_used + PASS_PATH_POINTS)
+            new_cap *= 2;
+        Vector2 *grown = (Vector2 *)realloc(pass_path_arena, sizeof(Vector2) * new_cap);
+        if (!grown)
+        {
+            pass->num_pts = 0;
+            return NULL;
         }
+        pass_path_arena = grown;
+        pass_path_capacity = new_cap;
+    }
 
-        if (in_pass && num_passes < MAX_PASSES)
+    pass->path_offset = pass_path_used;
+    pass->num_pts = 0;
+    Vector2 *pts = pass_path_arena + pass->path_offset;
+    double step = (pass->los_epoch - pass->aos_epoch) / (PASS_PATH_POINTS - 1);
+    if (step > 0)
+    {
+        SgpResonance res = {0};
+        for (int k = 0; k < PASS_PATH_POINTS; k++)
         {
-            current_pass.los_epoch = t;
-            current_pass.num_pts = 0;
-            double step = (current_pass.los_epoch - current_pass.aos_epoch) / 399.0;
-            if (step > 0)
-            {
-                current_pass.max_el = -90.0f;
-                for (int k = 0; k < 400; k++)
-                {
-                    double pt = current_pass.aos_epoch + k * step;
-                    double pt_unix = get_unix_from_epoch(pt);
-                    double p_gmst = epoch_to_gmst(pt);
-                    double p_az, p_el;
-                    get_az_el(calculate_position(current_sat, pt_unix), p_gmst, home_location.lat, home_location.lon, home_location.alt, &p_az, &p_el);
-                    current_pass.path_pts[current_pass.num_pts++] = (Vector2){(float)p_az, (float)p_el};
-                    
-                    if (p_el > current_pass.max_el)
-                    {
-                        current_pass.max_el = (float)p_el;
-                        current_pass.max_el_epoch = pt;
-                    }
-                }
-            }
-            passes[num_passes++] = current_pass;
+            double pt = pass->aos_epoch + k * step;
+            double p_az, p_el;
+            get_az_el(calculate_position_r(pass->sat, get_unix_from_epoch(pt), &res), epoch_to_gmst(pt), pass_obs.lat, pass_obs.lon, pass_obs.alt, &p_az, &p_el);
+            pts[pass->num_pts++] = (Vector2){(float)p_az, (float)p_el};
         }
     }
+    pass_path_used += pass->num_pts;
+    return pts;
+}
 
-    /* make sure the list actually makes sense chronologically */
-    /* Sort overall passes generated by timeframe chronological arrival order */
-    qsort(passes, num_passes, sizeof(SatPass), compare_passes);
+/* background all-satellite search; the ui polls it every frame and swaps the results in once it's done */
+static PassSearch *bg_search = NULL;
+static BackgroundThread *bg_thread = NULL;
+static volatile int bg_done = 0;
+
+static void pass_search_thread(void *arg)
+{
+    run_pass_search((PassSearch *)arg);
+    __sync_synchronize(); /* results have to be visible before the done flag */
+    bg_done = 1;
+}
+
+void CancelPassCalculation(void)
+{
+    if (!bg_search)
+        return;
+    bg_search->cancel = 1;
+    BackgroundThreadJoin(bg_thread);
+    free_pass_search(bg_search);
+    bg_thread = NULL;
+    bg_search = NULL;
+}
+
+void StartPassCalculation(double start_epoch)
+{
+    CancelPassCalculation();
+
+    /* switching over from a single satellite, its passes don't belong in the all-passes list */
+    if (last_pass_calc_sat != NULL)
+        num_passes = 0;
+    last_pass_calc_sat = NULL;
+
+    bg_search = create_pass_search(NULL, start_epoch);
+    if (!bg_search)
+        return;
+    bg_done = 0;
+    bg_thread = BackgroundThreadStart(pass_search_thread, bg_search);
+    if (!bg_thread)
+    {
+        /* no thread for us, just do it here */
+        run_pass_search(bg_search);
+        publish_pass_search(bg_search, NULL);
+        free_pass_search(bg_search);
+        bg_search = NULL;
+    }
+}
+
+bool PollPassCalculation(void)
+{
+    if (!bg_search || !bg_done)
+        return false;
+    __sync_synchronize();
+    BackgroundThreadJoin(bg_thread);
+    publish_pass_search(bg_search, NULL);
+    free_pass_search(bg_search);
+    bg_thread = NULL;
+    bg_search = NULL;
+    return true;
+}
+
+PassSearchStats GetPassSearchStats(void)
+{
+    return last_pass_stats;
+}
+
+bool IsPassCalculationRunning(void)
+{
+    return bg_search != NULL;
+}
+
+float GetPassCalculationProgress(void)
+{
+    if (!bg_search)
+        return 1.0f;
+    /* the max elevation refine is a small fraction of the coarse search, give it the last tenth of the bar */
+    float scan = bg_search->target_count > 0 ? (float)bg_search->sats_done / bg_search->target_count : 1.0f;
+    float refine = bg_search->result_count > 0 ? (float)bg_search->passes_done / bg_search->result_count : 0.0f;
+    return scan * 0.9f + refine * 0.1f;
+}
+
+/* synchronous search, used for the single satellite view (and anything that needs the answer right now) */
+void CalculatePasses(Satellite *sat, double start_epoch)
+{
+    CancelPassCalculation();
+
+    PassSearch *search = create_pass_search(sat, start_epoch);
+    if (!search)
+    {
+        num_passes = 0;
+        last_pass_calc_sat = sat;
+        return;
+    }
+    run_pass_search(search);
+    publish_pass_search(search, sat);
+    free_pass_search(search);
+}
+
+/* --- publishing a catalog built elsewhere (a TLE pull) without losing what the user was looking at --- */
+
+/* old slot -> new slot (or -1), by catalog number */
+static int *match_catalog_slots(const Satellite *catalog, int count)
+{
+    int *old_to_new = (int *)malloc(sizeof(int) * (sat_count > 0 ? sat_count : 1));
+    if (!old_to_new)
+        return NULL;
+    for (int i = 0; i < sat_count; i++)
+        old_to_new[i] = -1;
+    for (int i = 0; i < count; i++)
+    {
+        int old = find_satellite_slot(norad_number(catalog[i].norad_id));
+        if (old >= 0 && old_to_new[old] < 0)
+            old_to_new[old] = i;
+    }
+    return old_to_new;
+}
+
+int swap_catalog(Satellite *catalog, int count, bool activate_new, Satellite **refs[], int ref_count, int *pass_index)
+{
+    CancelPassCalculation(); /* its targets are slots of the old catalog */
+
+    /* old_to_new follows the norad id, same_elements[] marks the slots whose TLE didn't change either: only those keep
+       anything that was propagated from the old elements */
+    int *old_to_new = match_catalog_slots(catalog, count);
+    bool *same_elements = (bool *)calloc(count > 0 ? count : 1, sizeof(bool));
+    if (!same_elements)
+    {
+        free(old_to_new);
+        old_to_new = NULL;
+    }
+    SatHot *hot = catalog_hot(catalog);
+    for (int i = 0; i < count; i++)
+        hot[i].is_active = activate_new;
+
+    int carried = 0;
+    for (int i = 0; old_to_new && i < sat_count; i++)
+    {
+        if (old_to_new[i] < 0)
+            continue;
+        const Satellite *old = &satellites[i];
+        Satellite *sat = &catalog[old_to_new[i]];
+        hot[old_to_new[i]].is_active = sat_hot[i].is_active;
+        carried++;
+        if (old->epoch_unix != sat->epoch_unix || old->mean_motion != sat->mean_motion)
+            continue;
+        same_elements[old_to_new[i]] = true;
+        hot[old_to_new[i]].current_pos = sat_hot[i].current_pos;
+        sat->resonance = old->resonance;
+        if (old->orbit_cached)
+        {
+            sat->orbit_cache = old->orbit_cache; /* the buffer just changes hands */
+            sat->orbit_cache_resolution = old->orbit_cache_resolution;
+            sat->orbit_cache_gen = old->orbit_cache_gen;
+            sat->cached_orbit_base_pos = old->cached_orbit_base_pos;
+            sat->cached_orbit_epoch = old->cached_orbit_epoch;
+            sat->orbit_cached = true;
+            satellites[i].orbit_cache = NULL;
+            satellites[i].orbit_cached = false;
+        }
+    }
+
+    for (int r = 0; r < ref_count; r++)
+    {
+        Satellite *old = *refs[r];
+        bool in_catalog = old && old >= satellites && old < satellites + sat_count;
+        int n = (in_catalog && old_to_new) ? old_to_new[old - satellites] : -1;
+        *refs[r] = (n >= 0) ? &catalog[n] : NULL;
+    }
+
+    /* passes were worked out from the old elements. pass cache entries check that themselves and follow by catalog number */
+    int kept = 0;
+    for (int i = 0; i < num_passes; i++)
+    {
+        int n = old_to_new ? old_to_new[passes[i].sat - satellites] : -1;
+        bool keep = n >= 0 && same_elements[n];
+        if (pass_index && *pass_index == i)
+            *pass_index = keep ? kept : -1;
+        if (!keep)
+            continue;
+        passes[kept] = passes[i];
+        passes[kept].sat = &catalog[n];
+        kept++;
+    }
+    num_passes = kept;
+    if (last_pass_calc_sat)
+    {
+        int n = old_to_new ? old_to_new[last_pass_calc_sat - satellites] : -1;
+        last_pass_calc_sat = (n >= 0 && same_elements[n]) ? &catalog[n] : NULL;
+        if (!last_pass_calc_sat)
+            num_passes = 0;
+    }
+
+    free(old_to_new);
+    free(same_elements);
+    free_catalog(satellites, sat_count);
+    satellites = catalog;
+    sat_hot = hot;
+    sat_count = count;
+    sat_catalog_rev++;
+    return carried;
 }
 
 /* formats the internal epoch into a HH:MM:SS string for quick glancing */
@@ -788,7 +2731,7 @@ void draw_satellite_orbit_arch(Satellite *sat, double current_epoch, double gmst
                                Vector2 scope_center, float scope_radius, float scope_az, float scope_el, 
                                float scope_beam, Color orbit_color)
 {
-    if (!sat || !sat->is_active) return;
+    if (!sat || !satellite_hot(sat)->is_active) return;
     
     // calculate how long it takes this space junk to go around the planet
     double period_days = (2.0 * PI / sat->mean_motion) / 86400.0;
@@ -3,7 +3,7 @@
 
 #include "types.h"
 
-#define MAX_PASSES 1000
+#define PASS_PATH_POINTS 400
 typedef struct
 {
     Satellite *sat;
@@ -11,28 +11,83 @@ typedef struct
     double los_epoch;
     double max_el_epoch;
     float max_el;
-    Vector2 path_pts[400];
+    int path_offset; // into the shared path arena, -1 until GetPassPath() resamples it
     int num_pts;
 } SatPass;
 
-extern SatPass passes[MAX_PASSES];
+/* as many passes as the window holds, replaced wholesale by every finished search */
+extern SatPass *passes;
 extern int num_passes;
 extern Satellite *last_pass_calc_sat;
+extern float pass_search_days;          // window of the all-satellite search
+extern float pass_search_days_targeted; // window when only the selected satellite is searched
 
 double get_current_real_time_epoch(void);
 double epoch_to_gmst(double epoch);
 void epoch_to_datetime_str(double epoch, char *buffer);
 void load_tle_data(const char *filename);
 void load_manual_tles(AppConfig *config);
+int append_manual_tles(Satellite *catalog, int count, const AppConfig *config);
+
+/* catalog number of a TLE's 5 character catalog number field, alpha-5 ("A0001" = 100001) included. -1 if it's none */
+int norad_number(const char *norad_id);
+/* satellites[] slot with that catalog number or -1. hash index, rebuilt on the first lookup after the catalog changed */
+int find_satellite_slot(int norad);
+/* folds objects listed more than once (celestrak groups overlap) into their first slot, keeping the newest epoch.
+   returns the new count. works on any catalog, so bumping sat_catalog_rev is up to whoever owns satellites[] */
+int merge_duplicate_satellites(Satellite *catalog, int count);
+
+/* spare catalogs for building the next one while the current one is on screen. a catalog reserves room for
+   CATALOG_RESERVE_SLOTS and never moves, grow_catalog() commits slots [0, count) and returns how many are usable */
+Satellite *alloc_catalog(void);
+int grow_catalog(Satellite *catalog, int count);
+void free_catalog(Satellite *catalog, int count);
+/* what the live catalog really takes: its committed chunks (slots and hot array), the orbit caches that exist and the
+   pass cache */
+size_t catalog_memory_bytes(void);
+/* makes catalog (count satellites) the live one and frees the old. satellites that were there before, by norad id, keep
+   is_active and the selection; with an unchanged TLE epoch also their orbit cache, passes and pass cache. the rest get
+   is_active = activate_new. every *refs[i] and *pass_index is moved to the new slot, NULL / -1 if it's gone.
+   main thread, between frames. returns how many satellites carried over */
+int swap_catalog(Satellite *catalog, int count, bool activate_new, Satellite **refs[], int ref_count, int *pass_index);
+/* the sat_hot[] entry of a satellite of the live catalog */
+SatHot *satellite_hot(const Satellite *sat);
+
+/* incremental parser for TLE downloads: feed it the body in whatever chunks it arrives, records get parsed and
+   sgp4init'ed as they complete, straight into a staging catalog every stream of a pull shares (they all have to be fed
+   from one thread). finish_staged_catalog() then only puts the satellites in order */
+typedef struct
+{
+    Satellite *catalog; // from alloc_catalog(), slots handed out in arrival order
+    int count;
+} TleStaging;
+typedef struct TleStream TleStream;
+TleStream *tle_stream_create(const char *source, TleStaging *staging);
+void tle_stream_feed(TleStream *stream, const char *data, size_t size);
+void tle_stream_finish(TleStream *stream);
+int tle_stream_count(const TleStream *stream);
+/* the stream's satellites stay in the staging catalog until finish_staged_catalog() drops them */
+void tle_stream_free(TleStream *stream);
+/* moves the satellites of streams, in stream order, to the front of the staging catalog and drops the rest (streams
+   that failed), in place. then writes them as the binary cache of cache_filename (the concatenated stream texts, NULL
+   for none) and merges duplicates. no copy of the catalog, safe off the main thread. returns the count */
+int finish_staged_catalog(TleStaging *staging, TleStream **streams, int count, const char *cache_filename);
 double normalize_epoch(double epoch);
 double get_unix_from_epoch(double epoch);
 
+// file stuff
+/* moves a finished tmp_path over path in one step, so path holds either the old or the new file and never goes missing
+   (a crash mid-save keeps the old one). rename() on posix, MoveFileEx on windows where rename() won't replace */
+bool replace_file(const char *tmp_path, const char *path);
+
 // orbit math stuff
 Vector3 calculate_sun_position(double current_time_days);
 bool is_sat_eclipsed(Vector3 pos_km, Vector3 sun_dir_norm);
 void get_map_coordinates(Vector3 pos, double gmst_deg, float earth_offset, float map_w, float map_h, float *out_x,
                          float *out_y);
 Vector3 calculate_position(Satellite *sat, double current_unix);
+/* reentrant version, res carries the deep-space integrator state between calls (NULL integrates from epoch every time) */
+Vector3 calculate_position_r(const Satellite *sat, double current_unix, SgpResonance *res);
 Vector3 calculate_moon_position(double current_time_days);
 void get_apsis_2d(Satellite *sat, double current_time, bool is_apoapsis, double gmst_deg, float earth_offset,
                   float map_w, float map_h, Vector2 *out);
@@ -40,8 +95,37 @@ void get_apsis_times(Satellite *sat, double current_time, double *out_peri_unix,
 void geodetic_to_ecef(double lat_deg, double lon_deg, double alt_m, double *ox, double *oy, double *oz);
 void get_az_el(Vector3 eci_pos, double gmst_deg, float obs_lat, float obs_lon, float obs_alt, double *az, double *el);
 void CalculatePasses(Satellite *sat, double start_epoch);
+/* all-satellite pass search on a background thread, PollPassCalculation() swaps the results into passes[] once done */
+void StartPassCalculation(double start_epoch);
+bool PollPassCalculation(void);
+void CancelPassCalculation(void);
+bool IsPassCalculationRunning(void);
+float GetPassCalculationProgress(void);
+
+/* what the last finished pass search cost, for the stats overlay and the pass_search_report log */
+typedef struct
+{
+    int candidates; // active satellites considered
+    int skipped;    // ruled out by can_sat_rise() without propagating
+    int cached;     // answered from the pass cache without scanning
+    int passes;
+    long long scan_calls;     // sgp4 calls to find the passes, crossing refinement included
+    long long refine_calls; // sgp4 calls pinning down the max elevation of every pass
+    double elapsed_ms;
+    bool adaptive;
+} PassSearchStats;
+
+/* adaptive stepping is the default, the old fixed 1/4 minute step is kept to compare against */
+extern bool pass_search_adaptive;
+extern bool pass_search_report; // print PassSearchStats to stdout after every search
+PassSearchStats GetPassSearchStats(void);
+/* PASS_PATH_POINTS az/el samples (x = az, y = el) for the polar plot, computed on first use. num_pts is valid afterwards */
+const Vector2 *GetPassPath(SatPass *pass);
+bool can_sat_rise(const Satellite *sat, const Marker *obs, double start_epoch, double window_days);
 void epoch_to_time_str(double epoch, char *str);
+/* allocates the satellite's orbit cache on first use, release_orbit_cache() hands the memory back */
 void update_orbit_cache(Satellite *sat, double current_epoch);
+void release_orbit_cache(Satellite *sat);
 bool is_orbit_cache_valid(Satellite *sat, Vector3 current_pos, float drift_threshold_km);
 int calculate_orbit_cache_resolution(double eccentricity, int active_sat_count, int total_sat_count);
 
@@ -0,0 +1,13 @@
+#ifndef ASTRO_INTERNAL_H
+#define ASTRO_INTERNAL_H
+
+#include "types.h"
+
+/* bits of astro.c that tools/ (the TLE parser benchmark) gets at, the app itself only goes through astro.h */
+
+/* single pass over the fixed TLE columns into sat and the sgp4init input obj, no heap. NULL if fine, otherwise what's
+   wrong */
+const char *parse_tle_record(const char *line0, int len0, const char *line1, int len1, const char *line2, int len2, Satellite *sat,
+                             struct TLEObject *obj);
+
+#endif // ASTRO_INTERNAL_H
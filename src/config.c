@@ -69,6 +69,13 @@ void LoadAppConfig(const char *filename, AppConfig *config)
     config->show_skybox = true;       // default
     config->show_first_run_dialog = false; //default
     config->hint_vsync = true;       // default
+    config->propagation_threads = 0; // default, one per core
+    config->pull_concurrency = 6;    // default
+    config->pull_timeout_s = 30;     // default
+    config->pass_search_fixed_step = false; // default
+    config->pass_days_all = 1.0f;           // default
+    config->pass_days_targeted = 3.0f;      // default
+    config->pass_search_report = false;     // default
     config->custom_tle_source_count = 0;
 
     if (FileExists(filename))
@@ -118,9 +125,14 @@ void LoadAppConfig(const char *filename, AppConfig *config)
             PARSE_INT("window_width", window_width);
             PARSE_INT("window_height", window_height);
             PARSE_INT("target_fps", target_fps);
+            PARSE_INT("propagation_threads", propagation_threads);
+            PARSE_INT("pull_concurrency", pull_concurrency);
+            PARSE_INT("pull_timeout_s", pull_timeout_s);
             PARSE_FLOAT("ui_scale", ui_scale);
             PARSE_FLOAT("earth_rotation_offset", earth_rotation_offset);
             PARSE_FLOAT("orbits_to_draw", orbits_to_draw);
+            PARSE_FLOAT("pass_days_all", pass_days_all);
+            PARSE_FLOAT("pass_days_targeted", pass_days_targeted);
 
             config->show_clouds = ParseJsonBool(text, "show_clouds", config->show_clouds);
             config->show_night_lights = ParseJsonBool(text, "show_night_lights", config->show_night_lights);
@@ -132,6 +144,8 @@ void LoadAppConfig(const char *filename, AppConfig *config)
             config->show_scattering = ParseJsonBool(text, "show_scattering", config->show_scattering);
             config->hint_vsync = ParseJsonBool(text, "hint_vsync", config->hint_vsync);
             config->show_first_run_dialog = ParseJsonBool(text, "show_first_run_dialog", config->show_first_run_dialog);
+            config->pass_search_fixed_step = ParseJsonBool(text, "pass_search_fixed_step", config->pass_search_fixed_step);
+            config->pass_search_report = ParseJsonBool(text, "pass_search_report", config->pass_search_report);
 
             // load manual TLEs
             char *mt_ptr = strstr(text, "\"manual_tles\"");
@@ -302,7 +316,7 @@ void LoadAppConfig(const char *filename, AppConfig *config)
         }
     }
     else {
-        printf("INFO: No config file found at %s! Showing first run dialog!\n", filename);
+        fprintf(stderr, "INFO: No config file found at %s! Showing first run dialog!\n", filename);
         sscanf("default","%63[^\"]",config->theme);
         config->window_width = 1920;
         config->window_height = 1080;
@@ -310,6 +324,7 @@ void LoadAppConfig(const char *filename, AppConfig *config)
         config->ui_scale = 1.15;
         config->earth_rotation_offset = 0.00;
         config->orbits_to_draw = 3.00;
+        config->propagation_threads = 0;
         config->show_clouds = true;
         config->show_night_lights = true;
         config->show_markers = true;
@@ -404,9 +419,14 @@ void SaveAppConfig(const char *filename, AppConfig *config)
     fprintf(file, "    \"window_width\": %d,\n", config->window_width);
     fprintf(file, "    \"window_height\": %d,\n", config->window_height);
     fprintf(file, "    \"target_fps\": %d,\n", config->target_fps);
+    fprintf(file, "    \"propagation_threads\": %d,\n", config->propagation_threads);
+    fprintf(file, "    \"pull_concurrency\": %d,\n", config->pull_concurrency);
+    fprintf(file, "    \"pull_timeout_s\": %d,\n", config->pull_timeout_s);
     fprintf(file, "    \"ui_scale\": %.2f,\n", config->ui_scale);
     fprintf(file, "    \"earth_rotation_offset\": %.2f,\n", config->earth_rotation_offset);
     fprintf(file, "    \"orbits_to_draw\": %.2f,\n", config->orbits_to_draw);
+    fprintf(file, "    \"pass_days_all\": %.2f,\n", config->pass_days_all);
+    fprintf(file, "    \"pass_days_targeted\": %.2f,\n", config->pass_days_targeted);
     fprintf(file, "    \"show_clouds\": %s,\n", config->show_clouds ? "true" : "false");
     fprintf(file, "    \"show_night_lights\": %s,\n", config->show_night_lights ? "true" : "false");
     fprintf(file, "    \"show_markers\": %s,\n", config->show_markers ? "true" : "false");
@@ -416,6 +436,8 @@ void SaveAppConfig(const char *filename, AppConfig *config)
     fprintf(file, "    \"show_scattering\": %s,\n", config->show_scattering ? "true" : "false");
     fprintf(file, "    \"show_skybox\": %s,\n", config->show_skybox ? "true" : "false");
     fprintf(file, "    \"hint_vsync\": %s,\n", config->hint_vsync ? "true" : "false");
+    fprintf(file, "    \"pass_search_fixed_step\": %s,\n", config->pass_search_fixed_step ? "true" : "false");
+    fprintf(file, "    \"pass_search_report\": %s,\n", config->pass_search_report ? "true" : "false");
     fprintf(file, "    \"show_first_run_dialog\": %s,\n", config->show_first_run_dialog ? "true" : "false");
 
     if (config->custom_tle_source_count > 0)
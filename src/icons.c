@@ -0,0 +1,176 @@
+#include "icons.h"
+#include <raymath.h>
+#include <rlgl.h>
+#include <stddef.h>
+
+/* no vertex buffer for the quad: each instance is 6 vertices (18 with the 2d wrap copies) and the corner comes out of
+   gl_VertexID. the only buffer is the per instance one */
+static const char *vsIcons = "#version 330\n"
+                             "layout(location = 0) in vec3 iconPos;\n"
+                             "layout(location = 1) in float iconSize;\n"
+                             "layout(location = 2) in vec4 iconColor;\n"
+                             "out vec2 fragTexCoord;\n"
+                             "out vec4 fragColor;\n"
+                             "uniform mat4 mvp;\n"
+                             "uniform int wrapMode;\n"
+                             "uniform float mapWidth;\n"
+                             "uniform vec2 viewport;\n"
+                             "uniform vec3 camPos;\n"
+                             "uniform vec3 camForward;\n"
+                             "uniform float occluderRadius;\n"
+                             "const vec2 corners[6] = vec2[6](vec2(0.0, 0.0), vec2(0.0, 1.0), vec2(1.0, 1.0), vec2(0.0, 0.0), vec2(1.0, 1.0), vec2(1.0, 0.0));\n"
+                             "void main() {\n"
+                             "    vec2 corner = corners[gl_VertexID % 6];\n"
+                             "    fragTexCoord = corner;\n"
+                             "    fragColor = iconColor;\n"
+                             "    if (wrapMode == 1) {\n"
+                             "        float copy = float(gl_VertexID / 6) - 1.0;\n"
+                             "        vec2 p = iconPos.xy + (corner - 0.5) * iconSize + vec2(copy * mapWidth, 0.0);\n"
+                             "        gl_Position = mvp * vec4(p, 0.0, 1.0);\n"
+                             "        return;\n"
+                             "    }\n"
+                             "    vec3 v = iconPos - camPos;\n"
+                             "    bool hidden = dot(v, camForward) <= 0.0;\n"
+                             "    float a = dot(v, v);\n"
+                             "    if (a >= 0.000001) {\n"
+                             "        float b = 2.0 * dot(camPos, v);\n"
+                             "        float c = dot(camPos, camPos) - occluderRadius * occluderRadius * 0.9801;\n"
+                             "        float t = -b / (2.0 * a);\n"
+                             "        if (t > 0.0 && t < 1.0 && c - (b * b) / (4.0 * a) < 0.0) hidden = true;\n"
+                             "    }\n"
+                             "    if (hidden) {\n"
+                             "        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);\n"
+                             "        return;\n"
+                             "    }\n"
+                             "    vec4 clip = mvp * vec4(iconPos, 1.0);\n"
+                             "    vec2 offset = (corner - 0.5) * iconSize * 2.0 / viewport;\n"
+                             "    gl_Position = vec4(clip.xy / clip.w + vec2(offset.x, -offset.y), 0.0, 1.0);\n"
+                             "}\n";
+
+static const char *fsIcons = "#version 330\n"
+                             "in vec2 fragTexCoord;\n"
+                             "in vec4 fragColor;\n"
+                             "out vec4 finalColor;\n"
+                             "uniform sampler2D texture0;\n"
+                             "void main() {\n"
+                             "    finalColor = texture(texture0, fragTexCoord) * fragColor;\n"
+                             "}\n";
+
+static Shader icon_shader;
+static int mvp_loc, wrap_mode_loc, map_width_loc, viewport_loc, cam_pos_loc, cam_forward_loc, occluder_loc, texture_loc;
+static unsigned int icon_vao = 0, icon_vbo = 0;
+static int icon_capacity = 0; // instances the vbo holds
+
+void IconRendererInit(void)
+{
+    icon_shader = LoadShaderFromMemory(vsIcons, fsIcons);
+    mvp_loc = GetShaderLocation(icon_shader, "mvp");
+    wrap_mode_loc = GetShaderLocation(icon_shader, "wrapMode");
+    map_width_loc = GetShaderLocation(icon_shader, "mapWidth");
+    viewport_loc = GetShaderLocation(icon_shader, "viewport");
+    cam_pos_loc = GetShaderLocation(icon_shader, "camPos");
+    cam_forward_loc = GetShaderLocation(icon_shader, "camForward");
+    occluder_loc = GetShaderLocation(icon_shader, "occluderRadius");
+    texture_loc = GetShaderLocation(icon_shader, "texture0");
+    icon_vao = rlLoadVertexArray();
+}
+
+void IconRendererUnload(void)
+{
+    if (icon_vbo)
+        rlUnloadVertexBuffer(icon_vbo);
+    if (icon_vao)
+        rlUnloadVertexArray(icon_vao);
+    UnloadShader(icon_shader);
+    icon_vao = icon_vbo = 0;
+    icon_capacity = 0;
+}
+
+/* the vao stays bound afterwards */
+static bool upload_icons(const IconInstance *icons, int count)
+{
+    if (!icon_vao || !rlEnableVertexArray(icon_vao))
+        return false;
+    if (count > icon_capacity)
+    {
+        /* grows by half again so a catalog slowly getting more active doesn't reallocate every frame */
+        int capacity = count + count / 2;
+        if (icon_vbo)
+            rlUnloadVertexBuffer(icon_vbo);
+        icon_vbo = rlLoadVertexBuffer(NULL, capacity * (int)sizeof(IconInstance), true);
+        rlSetVertexAttribute(0, 3, RL_FLOAT, false, sizeof(IconInstance), offsetof(IconInstance, pos));
+        rlSetVertexAttribute(1, 1, RL_FLOAT, false, sizeof(IconInstance), offsetof(IconInstance, size));
+        rlSetVertexAttribute(2, 4, RL_UNSIGNED_BYTE, true, sizeof(IconInstance), offsetof(IconInstance, color));
+        for (int i = 0; i < 3; i++)
+        {
+            rlEnableVertexAttribute(i);
+            rlSetVertexAttributeDivisor(i, 1);
+        }
+        icon_capacity = capacity;
+    }
+    rlUpdateVertexBuffer(icon_vbo, icons, count * (int)sizeof(IconInstance), 0);
+    return true;
+}
+
+static void draw_icons(Texture2D texture, int vertices_per_icon, int count)
+{
+    int slot = 0;
+    rlActiveTextureSlot(0);
+    rlEnableTexture(texture.id);
+    rlSetUniform(texture_loc, &slot, RL_SHADER_UNIFORM_INT, 1);
+    rlDrawVertexArrayInstanced(0, vertices_per_icon, count);
+    rlDisableVertexArray();
+    rlDisableTexture();
+    rlDisableShader();
+}
+
+void IconBatchDraw3D(Texture2D texture, const IconInstance *icons, int count, Camera3D camera, float occluder_radius)
+{
+    if (count <= 0 || icon_shader.id == rlGetShaderIdDefault())
+        return;
+    rlDrawRenderBatchActive();
+
+    /* the same matrices GetWorldToScreen() builds, so the icons sit exactly where the per-icon path put them */
+    float width = (float)GetScreenWidth(), height = (float)GetScreenHeight();
+    Matrix proj = MatrixPerspective(camera.fovy * DEG2RAD, (double)width / (double)height, rlGetCullDistanceNear(), rlGetCullDistanceFar());
+    Matrix mvp = MatrixMultiply(GetCameraMatrix(camera), proj);
+    Vector3 forward = Vector3Normalize(Vector3Subtract(camera.target, camera.position));
+    Vector2 viewport = {width, height};
+    int wrap_mode = 0;
+
+    rlEnableShader(icon_shader.id);
+    rlSetUniformMatrix(mvp_loc, mvp);
+    rlSetUniform(wrap_mode_loc, &wrap_mode, RL_SHADER_UNIFORM_INT, 1);
+    rlSetUniform(viewport_loc, &viewport, RL_SHADER_UNIFORM_VEC2, 1);
+    rlSetUniform(cam_pos_loc, &camera.position, RL_SHADER_UNIFORM_VEC3, 1);
+    rlSetUniform(cam_forward_loc, &forward, RL_SHADER_UNIFORM_VEC3, 1);
+    rlSetUniform(occluder_loc, &occluder_radius, RL_SHADER_UNIFORM_FLOAT, 1);
+    if (!upload_icons(icons, count))
+    {
+        rlDisableShader();
+        return;
+    }
+    draw_icons(texture, 6, count);
+}
+
+void IconBatchDraw2D(Texture2D texture, const IconInstance *icons, int count, float map_w)
+{
+    if (count <= 0 || icon_shader.id == rlGetShaderIdDefault())
+        return;
+    rlDrawRenderBatchActive();
+
+    /* BeginMode2D() left the camera in the modelview, same product the internal batch draws with */
+    Matrix mvp = MatrixMultiply(rlGetMatrixModelview(), rlGetMatrixProjection());
+    int wrap_mode = 1;
+
+    rlEnableShader(icon_shader.id);
+    rlSetUniformMatrix(mvp_loc, mvp);
+    rlSetUniform(wrap_mode_loc, &wrap_mode, RL_SHADER_UNIFORM_INT, 1);
+    rlSetUniform(map_width_loc, &map_w, RL_SHADER_UNIFORM_FLOAT, 1);
+    if (!upload_icons(icons, count))
+    {
+        rlDisableShader();
+        return;
+    }
+    draw_icons(texture, 18, count);
+}
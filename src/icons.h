@@ -0,0 +1,27 @@
+#ifndef ICONS_H
+#define ICONS_H
+
+#include "raylib.h"
+
+/* one satellite icon: where, how big and in what tint. 20 bytes, uploaded as is as one instance */
+typedef struct
+{
+    Vector3 pos; // 3d: world position (draw units). 2d: map position in x/y, z unused
+    float size;  // 3d: pixels on screen. 2d: map units
+    Color color;
+} IconInstance;
+
+/* needs a GL 3.3 context, call after InitWindow() */
+void IconRendererInit(void);
+void IconRendererUnload(void);
+
+/* every icon in one instanced draw. whatever raylib has batched up so far is flushed first, so the icons land on top of
+   it just like DrawTexturePro() calls at this point would */
+
+/* screen space pass after EndMode3D(): projects with camera on the gpu, skips icons behind the camera or behind a
+   sphere of occluder_radius at the origin */
+void IconBatchDraw3D(Texture2D texture, const IconInstance *icons, int count, Camera3D camera, float occluder_radius);
+/* inside BeginMode2D(): every icon three times, at x - map_w, x and x + map_w, for the wrapped map */
+void IconBatchDraw2D(Texture2D texture, const IconInstance *icons, int count, float map_w);
+
+#endif // ICONS_H
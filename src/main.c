@@ -5,9 +5,16 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
+#include <time.h>
 
+#include "arena.h"
 #include "astro.h"
 #include "config.h"
+#include "icons.h"
+#include "orbits.h"
+#include "propagator.h"
+#include "threadpool.h"
 
 static const char* GetAssetPath(const char* theme, const char* filename) {
     static char path[256];
@@ -273,6 +280,7 @@ static AppConfig cfg = {
     .show_scattering = false,
     .hint_vsync = false,
     .orbit_cache_drift_threshold_km = 50.0f,
+    .propagation_threads = 0,
     .bg_color = {0, 0, 0, 255},
     .text_main = {255, 255, 255, 255},
     .theme = "default",
@@ -349,8 +357,8 @@ static Mesh GenEarthMesh(float radius, int slices, int rings)
     return mesh;
 }
 
-/* render orbit lines in 3d space */
-static void draw_orbit_3d(Satellite *sat, double current_epoch, bool is_highlighted, float alpha, int step)
+/* render orbit lines in 3d space, for the few that don't go through the orbit line buffer (orbits.c) */
+static void draw_orbit_3d(Satellite *sat, double current_epoch, bool is_highlighted, float alpha)
 {
     Color orbitColor = ApplyAlpha(is_highlighted ? cfg.orbit_highlighted : cfg.orbit_normal, alpha);
 
@@ -395,21 +403,8 @@ static void draw_orbit_3d(Satellite *sat, double current_epoch, bool is_highligh
         if (!sat->orbit_cached)
             return;
         
-        Vector3 prev_pos = sat->orbit_cache[0];
-        int cache_size = sat->orbit_cache_resolution;
-        
-        for (int i = step; i < cache_size; i += step)
-        {
-            Vector3 pos = sat->orbit_cache[i];
-            DrawLine3D(prev_pos, pos, orbitColor);
-            prev_pos = pos;
-        }
-        
-        // Draw final segment if needed
-        if ((cache_size - 1) % step != 0)
-        {
-            DrawLine3D(prev_pos, sat->orbit_cache[cache_size - 1], orbitColor);
-        }
+        for (int i = 1; i < sat->orbit_cache_resolution; i++)
+            DrawLine3D(sat->orbit_cache[i - 1], sat->orbit_cache[i], orbitColor);
     }
 }
 
@@ -528,9 +523,344 @@ static bool GetMouseEarthIntersection(Vector2 mouse, bool is_2d, Camera2D cam2d,
     }
 }
 
-int main(void)
+/* --- headless pass prediction, for cron jobs and benchmarks on machines without a display --- */
+
+static void PrintHeadlessUsage(void)
+{
+    fprintf(stderr,
+            "usage: TLEscope --headless [options]\n"
+            "  --lat DEG --lon DEG --alt M   observer (-90..90, -180..180, -1000..100000), defaults to home_location from settings.json\n"
+            "  --start TIME                  'now' (default), unix seconds or YYYY-MM-DD[THH:MM[:SS]][Z] UTC\n"
+            "  --days N                      search window in days, up to 365 (default: pass_days_all from settings.json)\n"
+            "  --min-el DEG                  drop passes peaking below this elevation, -90..90 (default 0)\n"
+            "  --sat ID                      NORAD id (alpha-5 too) or exact name, repeatable (default: every loaded satellite)\n"
+            "  --tle FILE                    catalog to load (default data.tle, manual TLEs from settings.json are added)\n"
+            "  --format csv|json             output written to stdout (default csv)\n"
+            "  --stats                       print search statistics to stderr\n");
+}
+
+/* a number and nothing else, within [lo, hi]. false for junk, trailing characters, nan and out of range */
+static bool ParseHeadlessNumber(const char *text, double lo, double hi, double *out)
+{
+    char *end;
+    double value = strtod(text, &end);
+    if (end == text || *end != '\0' || !(value >= lo && value <= hi))
+        return false;
+    *out = value;
+    return true;
+}
+
+/* 'now', plain unix seconds, or an ISO-ish UTC date (a trailing Z is fine). -1 if it doesn't parse */
+static double ParseHeadlessTime(const char *text)
+{
+    if (strcmp(text, "now") == 0)
+        return get_unix_from_epoch(get_current_real_time_epoch());
+
+    char *end;
+    double unix_time = strtod(text, &end);
+    if (*end == '\0' && end != text)
+        return unix_time >= 0.0 && isfinite(unix_time) ? unix_time : -1.0;
+
+    int y, mo, d, h = 0, mi = 0, s = 0, used = 0;
+    if (sscanf(text, "%4d-%2d-%2d%n", &y, &mo, &d, &used) != 3)
+        return -1.0;
+    const char *rest = text + used;
+    if (*rest == 'T' || *rest == ' ')
+    {
+        used = 0;
+        if (sscanf(rest + 1, "%2d:%2d%n:%2d%n", &h, &mi, &used, &s, &used) < 2)
+            return -1.0;
+        rest += 1 + used;
+    }
+    if (*rest == 'Z')
+        rest++;
+
+    static const int month_days[12] = {31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    bool leap = (y % 4 == 0 && y % 100 != 0) || y % 400 == 0;
+    if (*rest != '\0' || y < 1970 || mo < 1 || mo > 12 || d < 1 || d > month_days[mo - 1] || (mo == 2 && d == 29 && !leap) || h < 0 ||
+        h > 23 || mi < 0 || mi > 59 || s < 0 || s > 59)
+        return -1.0;
+
+    /* days since 1970-01-01 on the proleptic gregorian calendar, no timegm() on every platform */
+    int yy = y - (mo <= 2);
+    int era = (yy >= 0 ? yy : yy - 399) / 400;
+    int yoe = yy - era * 400;
+    int doy = (153 * (mo + (mo > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    double days = era * 146097.0 + doe - 719468.0;
+    return days * 86400.0 + h * 3600.0 + mi * 60.0 + s;
+}
+
+static void FormatHeadlessTime(double epoch, char *out, size_t size)
+{
+    time_t t = (time_t)floor(get_unix_from_epoch(epoch) + 0.5);
+    struct tm *tm_info = gmtime(&t);
+    if (tm_info)
+        strftime(out, size, "%Y-%m-%dT%H:%M:%SZ", tm_info);
+    else
+        snprintf(out, size, "invalid");
+}
+
+static bool HeadlessSatMatches(const Satellite *sat, const char *id)
+{
+    bool numeric = *id != '\0';
+    for (const char *c = id; *c; c++)
+        if (*c < '0' || *c > '9')
+            numeric = false;
+    if (numeric)
+        return norad_number(sat->norad_id) == atoi(id);
+    /* alpha-5 ("A0001") as written in the TLE, the letter in either case */
+    if (strlen(id) == 5 && isalpha((unsigned char)id[0]))
+    {
+        char field[6];
+        memcpy(field, id, sizeof(field));
+        field[0] = (char)toupper((unsigned char)field[0]);
+        int number = norad_number(field);
+        if (number >= 0)
+            return norad_number(sat->norad_id) == number;
+    }
+
+    const char *a = sat->name, *b = id;
+    while (*a && *b && tolower((unsigned char)*a) == tolower((unsigned char)*b))
+        a++, b++;
+    return *a == '\0' && *b == '\0';
+}
+
+static double HeadlessAzimuth(Satellite *sat, double epoch)
+{
+    double az, el;
+    get_az_el(calculate_position(sat, get_unix_from_epoch(epoch)), epoch_to_gmst(epoch), home_location.lat, home_location.lon, home_location.alt, &az, &el);
+    return az;
+}
+
+static void PrintJsonString(const char *text)
+{
+    putchar('"');
+    for (const unsigned char *c = (const unsigned char *)text; *c; c++)
+    {
+        if (*c == '"' || *c == '\\')
+            printf("\\%c", *c);
+        else if (*c < 0x20)
+            printf("\\u%04x", *c);
+        else
+            putchar(*c);
+    }
+    putchar('"');
+}
+
+/* loads the catalog, runs the same pass search the passes window uses and streams the result to stdout.
+   never touches raylib's window, so it works over ssh and in CI */
+static int RunHeadless(int argc, char **argv)
 {
+    const char *tle_file = "data.tle";
+    const char *format = "csv";
+    double start_unix = get_unix_from_epoch(get_current_real_time_epoch());
+    double days = cfg.pass_days_all;
+    double min_el = 0.0;
+    double lat = home_location.lat, lon = home_location.lon, alt = home_location.alt;
+    bool print_stats = false;
+    const char **sat_ids = (const char **)calloc(argc, sizeof(char *));
+    int sat_id_count = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char *arg = argv[i];
+        const char *val = (i + 1 < argc) ? argv[i + 1] : NULL;
+        bool has_val = true;
+        bool bad_value = false;
+
+        if (strcmp(arg, "--headless") == 0)
+            has_val = false;
+        else if (strcmp(arg, "--stats") == 0)
+        {
+            print_stats = true;
+            has_val = false;
+        }
+        else if (strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0)
+        {
+            PrintHeadlessUsage();
+            free(sat_ids);
+            return 0;
+        }
+        else if (!val)
+        {
+            fprintf(stderr, "%s needs a value\n", arg);
+            free(sat_ids);
+            return 1;
+        }
+        else if (strcmp(arg, "--lat") == 0)
+            bad_value = !ParseHeadlessNumber(val, -90.0, 90.0, &lat);
+        else if (strcmp(arg, "--lon") == 0)
+            bad_value = !ParseHeadlessNumber(val, -180.0, 180.0, &lon);
+        else if (strcmp(arg, "--alt") == 0)
+            bad_value = !ParseHeadlessNumber(val, -1000.0, 100000.0, &alt);
+        else if (strcmp(arg, "--days") == 0)
+            bad_value = !ParseHeadlessNumber(val, 0.0, 365.0, &days);
+        else if (strcmp(arg, "--min-el") == 0)
+            bad_value = !ParseHeadlessNumber(val, -90.0, 90.0, &min_el);
+        else if (strcmp(arg, "--tle") == 0)
+            tle_file = val;
+        else if (strcmp(arg, "--format") == 0)
+            format = val;
+        else if (strcmp(arg, "--sat") == 0)
+            sat_ids[sat_id_count++] = val;
+        else if (strcmp(arg, "--start") == 0)
+        {
+            start_unix = ParseHeadlessTime(val);
+            if (start_unix < 0.0)
+            {
+                fprintf(stderr, "Can't parse start time '%s'\n", val);
+                free(sat_ids);
+                return 1;
+            }
+        }
+        else
+        {
+            fprintf(stderr, "Unknown option %s\n", arg);
+            PrintHeadlessUsage();
+            free(sat_ids);
+            return 1;
+        }
+        /* a typo would quietly predict for some other place or window, so anything odd stops the run */
+        if (bad_value)
+        {
+            fprintf(stderr, "Bad value '%s' for %s, see --help for the ranges\n", val, arg);
+            free(sat_ids);
+            return 1;
+        }
+        if (has_val)
+            i++;
+    }
+    home_location.lat = (float)lat;
+    home_location.lon = (float)lon;
+    home_location.alt = (float)alt;
+
+    bool json = strcmp(format, "json") == 0;
+    if (!json && strcmp(format, "csv") != 0)
+    {
+        fprintf(stderr, "Unknown format '%s', expected csv or json\n", format);
+        free(sat_ids);
+        return 1;
+    }
+    if (days <= 0.0 || days > 365.0)
+    {
+        fprintf(stderr, "--days has to be between 0 and 365\n");
+        free(sat_ids);
+        return 1;
+    }
+
+    load_tle_data(tle_file);
+    load_manual_tles(&cfg);
+    if (sat_count == 0)
+    {
+        fprintf(stderr, "No satellites loaded from %s\n", tle_file);
+        free(sat_ids);
+        return 2;
+    }
+
+    int selected = 0;
+    for (int i = 0; i < sat_count; i++)
+    {
+        bool want = sat_id_count == 0;
+        for (int k = 0; k < sat_id_count && !want; k++)
+            want = HeadlessSatMatches(&satellites[i], sat_ids[k]);
+        sat_hot[i].is_active = want;
+        selected += want;
+    }
+    free(sat_ids);
+    if (selected == 0)
+    {
+        fprintf(stderr, "None of the requested satellites are in the catalog\n");
+        return 2;
+    }
+
+    pass_search_report = false;
+    pass_search_days = (float)days;
+    double start_epoch = unix_to_epoch(start_unix);
+    CalculatePasses(NULL, start_epoch);
+
+    if (json)
+        printf("[\n");
+    else
+        printf("norad_id,name,aos_utc,aos_az,max_utc,max_el,max_az,los_utc,los_az,duration_s\n");
+
+    int printed = 0;
+    for (int i = 0; i < num_passes; i++)
+    {
+        SatPass *p = &passes[i];
+        if (p->max_el < min_el)
+            continue;
+
+        char aos_str[32], max_str[32], los_str[32];
+        FormatHeadlessTime(p->aos_epoch, aos_str, sizeof(aos_str));
+        FormatHeadlessTime(p->max_el_epoch, max_str, sizeof(max_str));
+        FormatHeadlessTime(p->los_epoch, los_str, sizeof(los_str));
+        double aos_az = HeadlessAzimuth(p->sat, p->aos_epoch);
+        double max_az = HeadlessAzimuth(p->sat, p->max_el_epoch);
+        double los_az = HeadlessAzimuth(p->sat, p->los_epoch);
+        double duration = (p->los_epoch - p->aos_epoch) * 86400.0;
+
+        if (json)
+        {
+            printf("%s  {\"norad_id\": %d, \"name\": ", printed ? ",\n" : "", norad_number(p->sat->norad_id));
+            PrintJsonString(p->sat->name);
+            printf(", \"aos_utc\": \"%s\", \"aos_az\": %.1f, \"max_utc\": \"%s\", \"max_el\": %.2f, \"max_az\": %.1f, \"los_utc\": \"%s\", \"los_az\": %.1f, "
+                   "\"duration_s\": %.0f}",
+                   aos_str, aos_az, max_str, p->max_el, max_az, los_str, los_az, duration);
+        }
+        else
+        {
+            /* names with commas or quotes get quoted, everything else goes out as is */
+            printf("%d,", norad_number(p->sat->norad_id));
+            if (strpbrk(p->sat->name, ",\""))
+            {
+                putchar('"');
+                for (const char *c = p->sat->name; *c; c++)
+                {
+                    if (*c == '"')
+                        putchar('"');
+                    putchar(*c);
+                }
+                putchar('"');
+            }
+            else
+                fputs(p->sat->name, stdout);
+            printf(",%s,%.1f,%s,%.2f,%.1f,%s,%.1f,%.0f\n", aos_str, aos_az, max_str, p->max_el, max_az, los_str, los_az, duration);
+        }
+        printed++;
+    }
+    if (json)
+        printf("%s]\n", printed ? "\n" : "");
+    fflush(stdout);
+
+    if (print_stats)
+    {
+        PassSearchStats stats = GetPassSearchStats();
+        fprintf(stderr, "%d satellites (%d skipped by the visibility filter), %d passes, %d above %.1f deg, %lld + %lld SGP4 calls, %.1f ms\n", stats.candidates,
+                stats.skipped, stats.passes, printed, min_el, stats.scan_calls, stats.refine_calls, stats.elapsed_ms);
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    bool headless = false;
+    for (int i = 1; i < argc; i++)
+        if (strcmp(argv[i], "--headless") == 0)
+            headless = true;
+    /* stdout is the data in headless mode, keep raylib's chatter out of it */
+    if (headless)
+        SetTraceLogLevel(LOG_WARNING);
+
     LoadAppConfig("settings.json", &cfg);
+    WorkerPoolInit(cfg.propagation_threads);
+    pass_search_adaptive = !cfg.pass_search_fixed_step;
+    pass_search_report = cfg.pass_search_report;
+    pass_search_days = cfg.pass_days_all;
+    pass_search_days_targeted = cfg.pass_days_targeted;
+
+    if (headless)
+        return RunHeadless(argc, argv);
 
     /* window setup and msaa */
     SetConfigFlags(FLAG_MSAA_4X_HINT | FLAG_WINDOW_RESIZABLE);
@@ -638,6 +968,9 @@ int main(void)
     int sunDirLocAtmosphere = GetShaderLocation(shaderAtmosphere, "sunDir");
     int viewPosLocAtmosphere = GetShaderLocation(shaderAtmosphere, "viewPos");
 
+    IconRendererInit();
+    OrbitLinesInit();
+
     DrawLoadingScreen(0.6f, "Generating Meshes...", logoTex);
     float draw_earth_radius = EARTH_RADIUS_KM / DRAW_SCALE;
     Mesh sphereMesh = GenEarthMesh(draw_earth_radius, 80, 80);
@@ -756,9 +1089,18 @@ int main(void)
     
     int current_update_idx = 0;
 
+    /* batch propagation state for the per-frame position update, rebuilt when the active set changes */
+    SatBatch frame_batch;
+    sat_batch_init(&frame_batch);
+    int *frame_sats = NULL;
+    Vector3 *frame_pos = NULL;
+    int frame_sat_count = 0, frame_sat_cap = 0;
+
     /* main loop */
     while (!WindowShouldClose() && !exit_app)
     {
+        FrameArenaReset(); /* last frame's scratch is dead once we get back here */
+
         if (cfg.reload_theme)
         {
             cfg.reload_theme = false;
@@ -945,16 +1287,20 @@ int main(void)
             int updates_per_frame = 20;  // only caches that are invalid get updated
             for (int i = 0; i < updates_per_frame; i++)
             {
-                if (satellites[current_update_idx].is_active)
+                if (sat_hot[current_update_idx].is_active)
                 {
                     // Only update if satellite drifted
                     if (!is_orbit_cache_valid(&satellites[current_update_idx], 
-                                              satellites[current_update_idx].current_pos,
+                                              sat_hot[current_update_idx].current_pos,
                                               cfg.orbit_cache_drift_threshold_km))
                     {
                         update_orbit_cache(&satellites[current_update_idx], current_epoch);
                     }
                 }
+                else
+                {
+                    release_orbit_cache(&satellites[current_update_idx]); // hidden satellites don't keep 4 kB of orbit around
+                }
                 current_update_idx = (current_update_idx + 1) % sat_count;
             }
         }
@@ -963,20 +1309,49 @@ int main(void)
 
         /* update current positions of all active sats */
         int active_render_count = 0;
-        for (int i = 0; i < sat_count; i++)
+        if (sat_count > frame_sat_cap)
         {
-            if (!satellites[i].is_active)
+            int new_cap = sat_count + sat_count / 4;
+            int *grown_sats = (int *)realloc(frame_sats, sizeof(int) * new_cap);
+            if (grown_sats)
+                frame_sats = grown_sats;
+            Vector3 *grown_pos = (Vector3 *)realloc(frame_pos, sizeof(Vector3) * new_cap);
+            if (grown_pos)
+                frame_pos = grown_pos;
+            if (grown_sats && grown_pos)
+                frame_sat_cap = new_cap;
+        }
+        bool batch_dirty = (frame_batch.catalog_rev != sat_catalog_rev);
+        int n_visible = 0;
+        for (int i = 0; i < sat_count && n_visible < frame_sat_cap; i++)
+        {
+            if (!sat_hot[i].is_active)
                 continue;
             if (hide_unselected && selected_sat != NULL && &satellites[i] != selected_sat)
                 continue;
-            satellites[i].current_pos = calculate_position(&satellites[i], current_unix);
+            if (n_visible >= frame_sat_count || frame_sats[n_visible] != i)
+                batch_dirty = true;
+            frame_sats[n_visible++] = i;
+        }
+        if (n_visible != frame_sat_count)
+            batch_dirty = true;
+        frame_sat_count = n_visible;
+
+        if (batch_dirty)
+            sat_batch_build(&frame_batch, frame_sats, frame_sat_count);
+        propagate_batch_parallel(&frame_batch, current_unix, frame_pos, frame_batch.count);
+
+        /* workers only fill frame_pos, everything that touches shared state happens here in lane order */
+        for (int lane = 0; lane < frame_batch.count; lane++)
+        {
+            int i = frame_batch.sat_index[lane];
+            sat_hot[i].current_pos = frame_pos[lane];
 
-            
             /* spaghetti is good, but orbital spaghetti isn't.
             sooooo if an orbital body ends up below 80% of earths radius, disable it because it's about to meet earth's theoritical singularity and get ejected at speeds higher than light speed. yeeeeeeeet*/
-            if (Vector3Length(satellites[i].current_pos) < EARTH_RADIUS_KM * 0.8f)
+            if (Vector3Length(sat_hot[i].current_pos) < EARTH_RADIUS_KM * 0.8f)
             {
-                satellites[i].is_active = false;
+                sat_hot[i].is_active = false;
                 if (selected_sat == &satellites[i])
                     selected_sat = NULL;
                 continue;
@@ -985,18 +1360,6 @@ int main(void)
             active_render_count++;
         }
 
-        int global_orbit_step = 1;
-        if (active_render_count > 13000)
-            global_orbit_step = 54;
-        else if (active_render_count > 5000)
-            global_orbit_step = 24;
-        else if (active_render_count > 2000)
-            global_orbit_step = 8;
-        else if (active_render_count > 500)
-            global_orbit_step = 4;
-        else if (active_render_count > 200)
-            global_orbit_step = 2;
-
         /* fading logic for selection isolation */
         bool should_hide = (hide_unselected && selected_sat != NULL);
         if (should_hide)
@@ -1084,13 +1447,13 @@ int main(void)
 
                 for (int i = 0; i < sat_count; i++)
                 {
-                    if (!satellites[i].is_active)
+                    if (!sat_hot[i].is_active)
                         continue;
                     if (hide_unselected && selected_sat != NULL && &satellites[i] != selected_sat)
                         continue;
 
                     float mx, my;
-                    get_map_coordinates(satellites[i].current_pos, gmst_deg, cfg.earth_rotation_offset, map_w, map_h, &mx, &my);
+                    get_map_coordinates(sat_hot[i].current_pos, gmst_deg, cfg.earth_rotation_offset, map_w, map_h, &mx, &my);
 
                     Vector2 screenPos = GetWorldToScreen2D((Vector2){mx, my}, Camera2DParams);
                     float dist = Vector2Distance(mousePos, screenPos);
@@ -1135,7 +1498,7 @@ int main(void)
                     float wheel = GetMouseWheelMove();
                     if (wheel != 0)
                     {
-                        if (IsKeyDown(KEY_LEFT_ALT) || IsKeyDown(KEY_RIGHT_ALT) || (is_pov_mode && selected_sat && selected_sat->is_active))
+                        if (IsKeyDown(KEY_LEFT_ALT) || IsKeyDown(KEY_RIGHT_ALT) || (is_pov_mode && selected_sat && satellite_hot(selected_sat)->is_active))
                         {
                             Camera3DParams.fovy -= wheel * 5.0f;
                             if (Camera3DParams.fovy < 10.0f) Camera3DParams.fovy = 10.0f;
@@ -1156,7 +1519,7 @@ int main(void)
                 float rot_speed = 1.5f * GetFrameTime();
                 bool moved = false;
                 
-                if (is_pov_mode && selected_sat && selected_sat->is_active)
+                if (is_pov_mode && selected_sat && satellite_hot(selected_sat)->is_active)
                 {
                     if (IsKeyDown(KEY_RIGHT)) { target_camAngleX -= rot_speed; moved = true; }
                     if (IsKeyDown(KEY_LEFT)) { target_camAngleX += rot_speed; moved = true; }
@@ -1184,12 +1547,12 @@ int main(void)
 
                 for (int i = 0; i < sat_count; i++)
                 {
-                    if (!satellites[i].is_active)
+                    if (!sat_hot[i].is_active)
                         continue;
                     if (hide_unselected && selected_sat != NULL && &satellites[i] != selected_sat)
                         continue;
 
-                    Vector3 draw_pos = Vector3Scale(satellites[i].current_pos, 1.0f / DRAW_SCALE);
+                    Vector3 draw_pos = Vector3Scale(sat_hot[i].current_pos, 1.0f / DRAW_SCALE);
                     if (Vector3DistanceSqr(Camera3DParams.target, draw_pos) > (camDistance * camDistance * 16.0f))
                         continue;
 
@@ -1329,9 +1692,9 @@ int main(void)
 
         Satellite *active_sat = hovered_sat ? hovered_sat : selected_sat;
 
-        if (!is_2d_view && is_pov_mode && selected_sat && selected_sat->is_active)
+        if (!is_2d_view && is_pov_mode && selected_sat && satellite_hot(selected_sat)->is_active)
         {
-            Vector3 sat_pos_3d = Vector3Scale(selected_sat->current_pos, 1.0f / DRAW_SCALE);
+            Vector3 sat_pos_3d = Vector3Scale(satellite_hot(selected_sat)->current_pos, 1.0f / DRAW_SCALE);
             Camera3DParams.position = sat_pos_3d;
             
             /* create an LVLH local coordinate frame */
@@ -1380,17 +1743,17 @@ int main(void)
 /* calculate radio footprint (visibility cone) */
 #define FP_RINGS 12
 #define FP_PTS 120
-        Vector3 fp_grid[FP_RINGS + 1][FP_PTS];
+        Vector3 (*fp_grid)[FP_PTS] = NULL;
         bool has_footprint = false;
 
-        if (active_sat && active_sat->is_active)
+        if (active_sat && satellite_hot(active_sat)->is_active && (fp_grid = FrameAlloc(sizeof(Vector3) * (FP_RINGS + 1) * FP_PTS)))
         {
-            float r = Vector3Length(active_sat->current_pos);
+            float r = Vector3Length(satellite_hot(active_sat)->current_pos);
             if (r > EARTH_RADIUS_KM)
             {
                 has_footprint = true;
                 float theta = acosf(EARTH_RADIUS_KM / r);
-                Vector3 s_norm = Vector3Normalize(active_sat->current_pos);
+                Vector3 s_norm = Vector3Normalize(satellite_hot(active_sat)->current_pos);
                 Vector3 up = fabsf(s_norm.y) > 0.99f ? (Vector3){1, 0, 0} : (Vector3){0, 1, 0};
                 Vector3 u = Vector3Normalize(Vector3CrossProduct(up, s_norm));
                 Vector3 v = Vector3CrossProduct(s_norm, u);
@@ -1465,7 +1828,7 @@ int main(void)
                 BeginScissorMode(sc_x, sc_y, sc_w, sc_h);
 
                 /* draw 2d footprint */
-                if (active_sat && has_footprint && active_sat->is_active && !(is_pov_mode && selected_sat != NULL))
+                if (active_sat && has_footprint && satellite_hot(active_sat)->is_active && !(is_pov_mode && selected_sat != NULL))
                 {
                     for (int i = 0; i < FP_RINGS; i++)
                     {
@@ -1519,10 +1882,13 @@ int main(void)
                     }
                 }
 
-                /* render all sats on 2d map */
-                for (int i = 0; i < sat_count; i++)
+                /* render all sats on 2d map. icons are collected and go out in one instanced draw after the tracks */
+                IconInstance *icons_2d = FrameAlloc(sizeof(IconInstance) * (sat_count > 0 ? sat_count : 1));
+                int icon_count_2d = 0, label_sat_2d = -1;
+                Color label_col_2d = WHITE;
+                for (int i = 0; i < sat_count && icons_2d; i++)
                 {
-                    if (!satellites[i].is_active)
+                    if (!sat_hot[i].is_active)
                         continue;
                     bool is_unselected = (selected_sat != NULL && &satellites[i] != selected_sat);
                     float sat_alpha = is_unselected ? unselected_fade : 1.0f;
@@ -1533,12 +1899,16 @@ int main(void)
                     Color sCol = (selected_sat == &satellites[i]) ? cfg.sat_selected : (hovered_sat == &satellites[i]) ? cfg.sat_highlighted : cfg.sat_normal;
                     sCol = ApplyAlpha(sCol, sat_alpha);
 
+                    int segments = fmin(4000, fmax(50, (int)(400 * cfg.orbits_to_draw)));
+                    Vector2 *track_pts = NULL;
+                    bool *is_sunlit_arr = NULL;
                     if (is_hl && !(is_pov_mode && &satellites[i] == selected_sat))
                     {
-                        int segments = fmin(4000, fmax(50, (int)(400 * cfg.orbits_to_draw)));
-                        Vector2 track_pts[4001];
-                        bool is_sunlit_arr[4001];
-
+                        track_pts = FrameAlloc(sizeof(Vector2) * (segments + 1));
+                        is_sunlit_arr = FrameAlloc(sizeof(bool) * (segments + 1));
+                    }
+                    if (track_pts && is_sunlit_arr)
+                    {
                         double period_days = (2.0 * PI / satellites[i].mean_motion) / 86400.0;
                         double time_step = (period_days * cfg.orbits_to_draw) / segments;
 
@@ -1595,25 +1965,29 @@ int main(void)
                         }
                     }
 
-                    float sat_mx, sat_my;
-                    get_map_coordinates(satellites[i].current_pos, gmst_deg, cfg.earth_rotation_offset, map_w, map_h, &sat_mx, &sat_my);
                     if (!(is_pov_mode && &satellites[i] == selected_sat))
                     {
-                        for (int offset_i = -1; offset_i <= 1; offset_i++)
+                        IconInstance *icon = &icons_2d[icon_count_2d++];
+                        get_map_coordinates(sat_hot[i].current_pos, gmst_deg, cfg.earth_rotation_offset, map_w, map_h, &icon->pos.x, &icon->pos.y);
+                        icon->pos.z = 0.0f;
+                        icon->size = m_size_2d;
+                        icon->color = sCol;
+                        if (is_hl)
                         {
-                            DrawTexturePro(
-                                satIcon, (Rectangle){0, 0, satIcon.width, satIcon.height}, (Rectangle){sat_mx + (offset_i * map_w), sat_my, m_size_2d, m_size_2d},
-                                (Vector2){m_size_2d / 2.f, m_size_2d / 2.f}, 0.0f, sCol
-                            );
-
-                            if (is_hl && Camera2DParams.zoom > 0.1f)
-                            {
-                                DrawUIText(customFont, satellites[i].name, sat_mx + (offset_i * map_w) + (m_size_2d / 2.f) + 4.f, sat_my - (m_size_2d / 2.f), m_text_2d, sCol);
-                            }
+                            label_sat_2d = icon_count_2d - 1;
+                            label_col_2d = sCol;
                         }
                     }
                 }
 
+                IconBatchDraw2D(satIcon, icons_2d, icon_count_2d, map_w);
+                if (label_sat_2d >= 0 && Camera2DParams.zoom > 0.1f)
+                {
+                    Vector3 label_pos = icons_2d[label_sat_2d].pos;
+                    for (int offset_i = -1; offset_i <= 1; offset_i++)
+                        DrawUIText(customFont, active_sat->name, label_pos.x + (offset_i * map_w) + (m_size_2d / 2.f) + 4.f, label_pos.y - (m_size_2d / 2.f), m_text_2d, label_col_2d);
+                }
+
                 /* ground station markers */
                 float hx = (home_location.lon / 360.0f) * map_w;
                 float hy = -(home_location.lat / 180.0f) * map_h;
@@ -1631,10 +2005,10 @@ int main(void)
                 }
 
                 /* slant range overlay 2d */
-                if (cfg.show_slant_range && active_sat && active_sat->is_active)
+                if (cfg.show_slant_range && active_sat && satellite_hot(active_sat)->is_active)
                 {
                     float sx, sy;
-                    get_map_coordinates(active_sat->current_pos, gmst_deg, cfg.earth_rotation_offset, map_w, map_h, &sx, &sy);
+                    get_map_coordinates(satellite_hot(active_sat)->current_pos, gmst_deg, cfg.earth_rotation_offset, map_w, map_h, &sx, &sy);
 
                     if (sx - hx > map_w / 2.0f)
                         sx -= map_w;
@@ -1653,8 +2027,7 @@ int main(void)
                         if (Camera2DParams.zoom > 0.1f)
                         {
                             Vector2 mid = {(p1.x + p2.x) / 2.0f, (p1.y + p2.y) / 2.0f};
-                            char rng_str[32];
-                            TextCopy(rng_str, TextFormat("%.1f km", range));
+                            const char *rng_str = FrameFormat("%.1f km", range);
                             Vector2 tSize = MeasureTextEx(customFont, rng_str, m_text_2d, 1.0f);
 
                             DrawRectangle(
@@ -1803,7 +2176,7 @@ int main(void)
             DrawSphere(sun_pos_3d, sun_radius * 1.5f, (Color){ 255, 255, 220, 255 });
 
             /* 3d footprint triangles */
-            if (active_sat && has_footprint && active_sat->is_active && !(is_pov_mode && selected_sat != NULL))
+            if (active_sat && has_footprint && satellite_hot(active_sat)->is_active && !(is_pov_mode && selected_sat != NULL))
             {
                 for (int i = 0; i < FP_RINGS; i++)
                 {
@@ -1823,9 +2196,11 @@ int main(void)
                 }
             }
 
+            /* the plain unselected orbits all share one color and fade, they go out in one draw after the loop */
+            OrbitLinesBegin();
             for (int i = 0; i < sat_count; i++)
             {
-                if (!satellites[i].is_active)
+                if (!sat_hot[i].is_active)
                     continue;
                 bool is_unselected = (selected_sat != NULL && &satellites[i] != selected_sat);
                 float sat_alpha = is_unselected ? unselected_fade : 1.0f;
@@ -1835,23 +2210,28 @@ int main(void)
                 bool is_hl = (active_sat == &satellites[i]);
                 if (!(is_pov_mode && &satellites[i] == selected_sat))
                 {
-                    draw_orbit_3d(&satellites[i], current_epoch, is_hl, sat_alpha, global_orbit_step);
+                    if (is_hl || &satellites[i] == selected_sat)
+                        draw_orbit_3d(&satellites[i], current_epoch, is_hl, sat_alpha);
+                    else
+                        OrbitLinesAdd(i);
                 }
 
                 if (is_hl && !(is_pov_mode && &satellites[i] == selected_sat))
                 {
-                    Vector3 draw_pos = Vector3Scale(satellites[i].current_pos, 1.0f / DRAW_SCALE);
+                    Vector3 draw_pos = Vector3Scale(sat_hot[i].current_pos, 1.0f / DRAW_SCALE);
                     DrawLine3D(Vector3Zero(), draw_pos, ApplyAlpha(cfg.orbit_highlighted, sat_alpha));
                 }
             }
 
+            OrbitLinesDraw(ApplyAlpha(cfg.orbit_normal, selected_sat != NULL ? unselected_fade : 1.0f));
+
             /* slant range overlay 3d line */
-            if (cfg.show_slant_range && active_sat && active_sat->is_active)
+            if (cfg.show_slant_range && active_sat && satellite_hot(active_sat)->is_active)
             {
                 float h_lat_rad = home_location.lat * DEG2RAD;
                 float h_lon_rad = (home_location.lon + gmst_deg + cfg.earth_rotation_offset) * DEG2RAD;
                 Vector3 h_pos3d = {cosf(h_lat_rad) * cosf(h_lon_rad) * draw_earth_radius, sinf(h_lat_rad) * draw_earth_radius, -cosf(h_lat_rad) * sinf(h_lon_rad) * draw_earth_radius};
-                Vector3 s_pos3d = Vector3Scale(active_sat->current_pos, 1.0f / DRAW_SCALE);
+                Vector3 s_pos3d = Vector3Scale(satellite_hot(active_sat)->current_pos, 1.0f / DRAW_SCALE);
                 DrawLine3D(h_pos3d, s_pos3d, ApplyAlpha(cfg.ui_accent, 0.6f));
             }
 
@@ -1912,12 +2292,12 @@ int main(void)
             Vector3 camForward = Vector3Normalize(Vector3Subtract(Camera3DParams.target, Camera3DParams.position));
 
             /* slant range text overlay 3d */
-            if (cfg.show_slant_range && active_sat && active_sat->is_active)
+            if (cfg.show_slant_range && active_sat && satellite_hot(active_sat)->is_active)
             {
                 float h_lat_rad = home_location.lat * DEG2RAD;
                 float h_lon_rad = (home_location.lon + gmst_deg + cfg.earth_rotation_offset) * DEG2RAD;
                 Vector3 h_pos3d = {cosf(h_lat_rad) * cosf(h_lon_rad) * draw_earth_radius, sinf(h_lat_rad) * draw_earth_radius, -cosf(h_lat_rad) * sinf(h_lon_rad) * draw_earth_radius};
-                Vector3 s_pos3d = Vector3Scale(active_sat->current_pos, 1.0f / DRAW_SCALE);
+                Vector3 s_pos3d = Vector3Scale(satellite_hot(active_sat)->current_pos, 1.0f / DRAW_SCALE);
 
                 Vector3 mid_pos = Vector3Lerp(h_pos3d, s_pos3d, 0.5f);
                 Vector3 toMid = Vector3Subtract(mid_pos, Camera3DParams.position);
@@ -1926,8 +2306,7 @@ int main(void)
                 {
                     Vector2 mid_screen = GetWorldToScreen(mid_pos, Camera3DParams);
                     double range = get_sat_range(active_sat, current_epoch, home_location);
-                    char rng_str[32];
-                    TextCopy(rng_str, TextFormat("%.1f km", range));
+                    const char *rng_str = FrameFormat("%.1f km", range);
                     Vector2 tSize = MeasureTextEx(customFont, rng_str, m_text_3d, 1.0f);
 
                     DrawRectangle(mid_screen.x - tSize.x / 2.0f - 4, mid_screen.y - tSize.y / 2.0f - 4, tSize.x + 8, tSize.y + 8, ApplyAlpha(cfg.ui_bg, 0.7f));
@@ -1936,7 +2315,7 @@ int main(void)
             }
 
             bool hide_apsis = (is_pov_mode && selected_sat != NULL && active_sat == selected_sat);
-            if (active_sat && active_sat->is_active && !hide_apsis)
+            if (active_sat && satellite_hot(active_sat)->is_active && !hide_apsis)
             {
                 bool is_unselected = (selected_sat != NULL && active_sat != selected_sat);
                 float sat_alpha = is_unselected ? unselected_fade : 1.0f;
@@ -1965,33 +2344,34 @@ int main(void)
                 }
             }
 
-            for (int i = 0; i < sat_count; i++)
+            /* projection, the behind-the-camera test and earth occlusion all happen in the icon shader now, this only
+               packs position and tint. the highlighted one still gets projected here for its label */
+            IconInstance *icons_3d = FrameAlloc(sizeof(IconInstance) * (sat_count > 0 ? sat_count : 1));
+            int icon_count_3d = 0;
+            for (int i = 0; i < sat_count && icons_3d; i++)
             {
-                if (!satellites[i].is_active)
+                if (!sat_hot[i].is_active || (is_pov_mode && &satellites[i] == selected_sat))
                     continue;
                 bool is_unselected = (selected_sat != NULL && &satellites[i] != selected_sat);
                 float sat_alpha = is_unselected ? unselected_fade : 1.0f;
                 if (sat_alpha <= 0.0f)
                     continue;
 
-                Vector3 draw_pos = Vector3Scale(satellites[i].current_pos, 1.0f / DRAW_SCALE);
-                Vector3 toTarget = Vector3Subtract(draw_pos, Camera3DParams.position);
+                Color sCol = (selected_sat == &satellites[i]) ? cfg.sat_selected : (hovered_sat == &satellites[i]) ? cfg.sat_highlighted : cfg.sat_normal;
+                icons_3d[icon_count_3d++] = (IconInstance){Vector3Scale(sat_hot[i].current_pos, 1.0f / DRAW_SCALE), m_size_3d, ApplyAlpha(sCol, sat_alpha)};
+            }
+            IconBatchDraw3D(satIcon, icons_3d, icon_count_3d, Camera3DParams, draw_earth_radius);
 
-                if (Vector3DotProduct(toTarget, camForward) > 0.0f && !IsOccludedByEarth(Camera3DParams.position, draw_pos, draw_earth_radius))
+            if (active_sat && satellite_hot(active_sat)->is_active && !(is_pov_mode && active_sat == selected_sat))
+            {
+                float sat_alpha = (selected_sat != NULL && active_sat != selected_sat) ? unselected_fade : 1.0f;
+                Vector3 draw_pos = Vector3Scale(satellite_hot(active_sat)->current_pos, 1.0f / DRAW_SCALE);
+                Vector3 toTarget = Vector3Subtract(draw_pos, Camera3DParams.position);
+                if (sat_alpha > 0.0f && Vector3DotProduct(toTarget, camForward) > 0.0f && !IsOccludedByEarth(Camera3DParams.position, draw_pos, draw_earth_radius))
                 {
-                    if (!(is_pov_mode && &satellites[i] == selected_sat))
-                    {
-                        bool is_hl = (active_sat == &satellites[i]);
-                        Color sCol = (selected_sat == &satellites[i]) ? cfg.sat_selected : (hovered_sat == &satellites[i]) ? cfg.sat_highlighted : cfg.sat_normal;
-                        sCol = ApplyAlpha(sCol, sat_alpha);
-                        Vector2 sp = GetWorldToScreen(draw_pos, Camera3DParams);
-                        DrawTexturePro(satIcon, (Rectangle){0, 0, satIcon.width, satIcon.height}, (Rectangle){sp.x, sp.y, m_size_3d, m_size_3d}, (Vector2){m_size_3d / 2.f, m_size_3d / 2.f}, 0.0f, sCol);
-
-                        if (is_hl)
-                        {
-                            DrawUIText(customFont, satellites[i].name, sp.x + (m_size_3d / 2.f) + 4.f, sp.y - (m_size_3d / 2.f), m_text_3d, sCol);
-                        }
-                    }
+                    Color sCol = (selected_sat == active_sat) ? cfg.sat_selected : (hovered_sat == active_sat) ? cfg.sat_highlighted : cfg.sat_normal;
+                    Vector2 sp = GetWorldToScreen(draw_pos, Camera3DParams);
+                    DrawUIText(customFont, active_sat->name, sp.x + (m_size_3d / 2.f) + 4.f, sp.y - (m_size_3d / 2.f), m_text_3d, ApplyAlpha(sCol, sat_alpha));
                 }
             }
 
@@ -2111,10 +2491,19 @@ int main(void)
     UnloadModel(moonModel);
     UnloadShader(shaderAtmosphere);
     UnloadModel(atmosphereModel);
+    IconRendererUnload();
+    OrbitLinesUnload();
     UnloadFont(customFont);
 
     SaveSatSelection();
     RotatorShutdown();
+    CancelPassCalculation();
+    WorkerPoolShutdown();
+
+    sat_batch_free(&frame_batch);
+    free(frame_sats);
+    free(frame_pos);
+    FrameArenaShutdown();
 
     CloseWindow();
     return 0;
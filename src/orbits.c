@@ -0,0 +1,421 @@
+#include "orbits.h"
+#include "types.h"
+#include <raymath.h>
+#include <rlgl.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ORBIT_SLOT_CHUNK 1024         // slots added at a time, also the row width of the slot texture
+#define ORBIT_UPLOADS_PER_FRAME 1024  // ~4 MB, so a catalog swap refills over a few frames instead of in one hitch
+#define ORBIT_LINE_WIDTH 1.5f         // pixels. a 1 px quad misses pixel centres on diagonals, 1.5 reads like a 1 px GL line
+#define ORBIT_IDLE_FRAMES 120         // a slot nobody added for this long goes back, undrawn slots still cost vertex work
+#define ORBIT_POOL_COUNT 3
+
+/* rlgl only draws instanced triangles, so every segment is an instance: attribute A reads point k, attribute B the
+   same buffer one point further, and the 6 vertices make a screen space quad between them. instance k belongs to
+   slot k / slotSize, the slot texture says how many points that slot holds this frame (0 = not drawn), and segments
+   past it collapse outside the clip volume. the same goes for the one that would join two slots */
+static const char *vsOrbitLines = "#version 330\n"
+                                  "layout(location = 0) in vec3 pointA;\n"
+                                  "layout(location = 1) in vec3 pointB;\n"
+                                  "uniform mat4 mvp;\n"
+                                  "uniform vec2 viewport;\n"
+                                  "uniform float lineWidth;\n"
+                                  "uniform int slotSize;\n"
+                                  "uniform sampler2D slotPoints;\n"
+                                  "const vec2 corners[6] = vec2[6](vec2(0.0, -1.0), vec2(1.0, -1.0), vec2(1.0, 1.0), vec2(0.0, -1.0), vec2(1.0, 1.0), vec2(0.0, 1.0));\n"
+                                  "void main() {\n"
+                                  "    int slot = gl_InstanceID / slotSize;\n"
+                                  "    int point = gl_InstanceID - slot * slotSize;\n"
+                                  "    int rowWidth = textureSize(slotPoints, 0).x;\n"
+                                  "    float points = texelFetch(slotPoints, ivec2(slot % rowWidth, slot / rowWidth), 0).r;\n"
+                                  "    if (float(point + 1) >= points) {\n"
+                                  "        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);\n"
+                                  "        return;\n"
+                                  "    }\n"
+                                  "    vec4 a = mvp * vec4(pointA, 1.0);\n"
+                                  "    vec4 b = mvp * vec4(pointB, 1.0);\n"
+                                  "    float da = a.z + a.w, db = b.z + b.w;\n"
+                                  "    if (da < 0.0 && db < 0.0) {\n"
+                                  "        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);\n"
+                                  "        return;\n"
+                                  "    }\n"
+                                  "    if (da < 0.0) a = mix(a, b, da / (da - db));\n"
+                                  "    else if (db < 0.0) b = mix(b, a, db / (db - da));\n"
+                                  "    vec2 dir = (b.xy / b.w - a.xy / a.w) * viewport;\n"
+                                  "    vec2 normal = length(dir) > 0.0001 ? normalize(vec2(-dir.y, dir.x)) : vec2(0.0, 1.0);\n"
+                                  "    vec2 corner = corners[gl_VertexID];\n"
+                                  "    vec4 p = corner.x > 0.5 ? b : a;\n"
+                                  "    p.xy += normal * corner.y * lineWidth / viewport * p.w;\n"
+                                  "    gl_Position = p;\n"
+                                  "}\n";
+
+static const char *fsOrbitLines = "#version 330\n"
+                                  "out vec4 finalColor;\n"
+                                  "uniform vec4 lineColor;\n"
+                                  "void main() {\n"
+                                  "    finalColor = lineColor;\n"
+                                  "}\n";
+
+static Shader line_shader;
+static int mvp_loc, viewport_loc, width_loc, slot_size_loc, slot_points_loc, color_loc;
+
+/* one buffer per orbit resolution class (see calculate_orbit_cache_resolution()), so a 180 point orbit doesn't drag
+   181 dead segments through the vertex shader. slots [0, count) of a pool are in use, a release leaves a hole that
+   compact_pool() fills with the pool's last slot, so the draw only covers live slots */
+typedef struct
+{
+    int points; // slot size, orbits of up to this many points go here
+    unsigned int vao, vbo, texture;
+    int capacity;
+    int count;
+    int wanted;                 // orbits added this frame, sizes the buffer for the next one
+    int drawn;                  // slots marked in this frame's texture
+    int *owner;                 // satellites[] index, -1 for a hole
+    unsigned int *gen;          // orbit_cache_gen of what the buffer holds, 0 = nothing
+    int *resolution;            // points uploaded
+    unsigned int *last_added;   // frame the slot's satellite was last added
+    float *slot_points;         // this frame's slot texture
+} OrbitPool;
+
+static OrbitPool pools[ORBIT_POOL_COUNT] = {{.points = 180}, {.points = 270}, {.points = ORBIT_CACHE_SIZE}};
+
+static int *sat_slot = NULL; // satellites[] index -> slot * ORBIT_POOL_COUNT + pool, or -1
+static int sat_slot_cap = 0;
+static unsigned int synced_rev = 0;
+static const Satellite *synced_catalog = NULL;
+
+static unsigned int frame_no = 0;
+static int uploads_left = 0;
+static OrbitLinesStats stats;
+
+void OrbitLinesInit(void)
+{
+    line_shader = LoadShaderFromMemory(vsOrbitLines, fsOrbitLines);
+    mvp_loc = GetShaderLocation(line_shader, "mvp");
+    viewport_loc = GetShaderLocation(line_shader, "viewport");
+    width_loc = GetShaderLocation(line_shader, "lineWidth");
+    slot_size_loc = GetShaderLocation(line_shader, "slotSize");
+    slot_points_loc = GetShaderLocation(line_shader, "slotPoints");
+    color_loc = GetShaderLocation(line_shader, "lineColor");
+}
+
+void OrbitLinesUnload(void)
+{
+    for (int p = 0; p < ORBIT_POOL_COUNT; p++)
+    {
+        OrbitPool *pool = &pools[p];
+        if (pool->vbo)
+            rlUnloadVertexBuffer(pool->vbo);
+        if (pool->vao)
+            rlUnloadVertexArray(pool->vao);
+        if (pool->texture)
+            rlUnloadTexture(pool->texture);
+        free(pool->owner);
+        free(pool->gen);
+        free(pool->resolution);
+        free(pool->last_added);
+        free(pool->slot_points);
+        *pool = (OrbitPool){.points = pool->points};
+    }
+    UnloadShader(line_shader);
+    free(sat_slot);
+    sat_slot = NULL;
+    sat_slot_cap = 0;
+    memset(&stats, 0, sizeof(stats));
+}
+
+/* which pool an orbit of this many points goes to, -1 if none fits */
+static int pool_for(int resolution)
+{
+    for (int p = 0; p < ORBIT_POOL_COUNT; p++)
+        if (resolution <= pools[p].points)
+            return p;
+    return -1;
+}
+
+/* every slot gone, the buffers stay */
+static void reset_slots(void)
+{
+    for (int p = 0; p < ORBIT_POOL_COUNT; p++)
+        pools[p].count = 0;
+    for (int i = 0; i < sat_slot_cap; i++)
+        sat_slot[i] = -1;
+    stats.resident = 0;
+}
+
+/* a bigger buffer and slot texture. the old contents aren't copied (rlgl has no buffer to buffer copy), the slots keep
+   their owners and just get uploaded again */
+static bool grow_pool(OrbitPool *pool)
+{
+    int capacity = pool->capacity ? pool->capacity * 2 : ORBIT_SLOT_CHUNK;
+    int *owner = (int *)realloc(pool->owner, sizeof(int) * capacity);
+    if (owner)
+        pool->owner = owner;
+    unsigned int *gen = (unsigned int *)realloc(pool->gen, sizeof(unsigned int) * capacity);
+    if (gen)
+        pool->gen = gen;
+    int *resolution = (int *)realloc(pool->resolution, sizeof(int) * capacity);
+    if (resolution)
+        pool->resolution = resolution;
+    unsigned int *last_added = (unsigned int *)realloc(pool->last_added, sizeof(unsigned int) * capacity);
+    if (last_added)
+        pool->last_added = last_added;
+    float *points = (float *)realloc(pool->slot_points, sizeof(float) * capacity);
+    if (points)
+        pool->slot_points = points;
+    if (!owner || !gen || !resolution || !last_added || !points)
+        return false;
+
+    if (!pool->vao)
+        pool->vao = rlLoadVertexArray();
+    size_t bytes = (size_t)capacity * pool->points * sizeof(Vector3);
+    if (!pool->vao || !rlEnableVertexArray(pool->vao))
+        return false;
+    unsigned int vbo = rlLoadVertexBuffer(NULL, (int)bytes, true);
+    if (!vbo)
+    {
+        rlDisableVertexArray();
+        return false;
+    }
+    rlSetVertexAttribute(0, 3, RL_FLOAT, false, sizeof(Vector3), 0);
+    rlSetVertexAttribute(1, 3, RL_FLOAT, false, sizeof(Vector3), sizeof(Vector3));
+    for (int i = 0; i < 2; i++)
+    {
+        rlEnableVertexAttribute(i);
+        rlSetVertexAttributeDivisor(i, 1);
+    }
+    rlDisableVertexArray();
+    if (pool->vbo)
+        rlUnloadVertexBuffer(pool->vbo);
+    pool->vbo = vbo;
+
+    if (pool->texture)
+        rlUnloadTexture(pool->texture);
+    memset(pool->slot_points, 0, sizeof(float) * capacity);
+    pool->texture = rlLoadTexture(pool->slot_points, ORBIT_SLOT_CHUNK, capacity / ORBIT_SLOT_CHUNK, PIXELFORMAT_UNCOMPRESSED_R32, 1);
+
+    for (int s = 0; s < pool->count; s++)
+        pool->gen[s] = 0;
+    stats.drawn -= pool->drawn; // whatever was marked this frame went with the old slot texture
+    pool->drawn = 0;
+    stats.bytes += bytes - (size_t)pool->capacity * pool->points * sizeof(Vector3);
+    pool->capacity = capacity;
+    return true;
+}
+
+static void release_slot(OrbitPool *pool, int slot)
+{
+    int owner = pool->owner[slot];
+    if (owner >= 0 && owner < sat_slot_cap)
+        sat_slot[owner] = -1;
+    if (pool->slot_points[slot] > 0.0f)
+    {
+        pool->drawn--;
+        stats.drawn--;
+    }
+    pool->owner[slot] = -1;
+    pool->gen[slot] = 0;
+    pool->slot_points[slot] = 0.0f;
+    stats.resident--;
+}
+
+/* the pool's last slot moves into the hole at slot. the points come again from the satellite's own orbit cache, so a
+   move costs an upload; out of budget the hole just waits for the next frame */
+static bool move_slot(OrbitPool *pool, int from, int to)
+{
+    int owner = pool->owner[from];
+    const Satellite *sat = &satellites[owner];
+    bool same = pool->gen[from] != 0 && pool->gen[from] == sat->orbit_cache_gen;
+    if (same)
+    {
+        if (uploads_left <= 0)
+            return false;
+        rlUpdateVertexBuffer(pool->vbo, sat->orbit_cache, sat->orbit_cache_resolution * (int)sizeof(Vector3),
+                             to * pool->points * (int)sizeof(Vector3));
+        uploads_left--;
+        stats.uploads++;
+    }
+    /* a stale slot is left to OrbitLinesAdd() to upload next frame, for this one it goes undrawn */
+    if (!same && pool->slot_points[from] > 0.0f)
+    {
+        pool->drawn--;
+        stats.drawn--;
+    }
+    pool->owner[to] = owner;
+    pool->gen[to] = same ? pool->gen[from] : 0;
+    pool->resolution[to] = pool->resolution[from];
+    pool->last_added[to] = pool->last_added[from];
+    pool->slot_points[to] = same ? pool->slot_points[from] : 0.0f;
+    pool->owner[from] = -1;
+    pool->gen[from] = 0;
+    pool->slot_points[from] = 0.0f;
+    sat_slot[owner] = to * ORBIT_POOL_COUNT + (int)(pool - pools);
+    return true;
+}
+
+/* satellites that lost their cache (hidden, catalog shrank) or haven't been added for a while give their slot back,
+   then the holes get filled from the top */
+static void compact_pool(OrbitPool *pool)
+{
+    for (int s = 0; s < pool->count; s++)
+    {
+        int owner = pool->owner[s];
+        if (owner >= 0 && (owner >= sat_count || !satellites[owner].orbit_cached || frame_no - pool->last_added[s] > ORBIT_IDLE_FRAMES))
+            release_slot(pool, s);
+    }
+    int hole = 0;
+    for (;;)
+    {
+        while (pool->count > 0 && pool->owner[pool->count - 1] < 0)
+            pool->count--;
+        while (hole < pool->count && pool->owner[hole] >= 0)
+            hole++;
+        if (hole >= pool->count || !move_slot(pool, pool->count - 1, hole))
+            break;
+    }
+}
+
+void OrbitLinesBegin(void)
+{
+    if (synced_rev != sat_catalog_rev || synced_catalog != satellites)
+    {
+        /* slots are keyed by satellites[] index, which means nothing in another catalog */
+        reset_slots();
+        synced_rev = sat_catalog_rev;
+        synced_catalog = satellites;
+    }
+    if (sat_count > sat_slot_cap)
+    {
+        int *grown = (int *)realloc(sat_slot, sizeof(int) * sat_count);
+        if (grown)
+        {
+            for (int i = sat_slot_cap; i < sat_count; i++)
+                grown[i] = -1;
+            sat_slot = grown;
+            sat_slot_cap = sat_count;
+        }
+    }
+    frame_no++;
+    stats.drawn = 0;
+    stats.uploads = 0;
+    for (int p = 0; p < ORBIT_POOL_COUNT; p++)
+    {
+        OrbitPool *pool = &pools[p];
+        /* grow up front to what last frame asked for, growing mid frame throws away that frame's uploads */
+        while (pool->capacity < pool->wanted && grow_pool(pool))
+            ;
+        pool->wanted = 0;
+        pool->drawn = 0;
+        if (pool->slot_points)
+            memset(pool->slot_points, 0, sizeof(float) * pool->capacity);
+    }
+    uploads_left = ORBIT_UPLOADS_PER_FRAME;
+}
+
+void OrbitLinesAdd(int sat_index)
+{
+    const Satellite *sat = &satellites[sat_index];
+    if (!sat->orbit_cached || sat_index >= sat_slot_cap)
+        return;
+    int p = pool_for(sat->orbit_cache_resolution);
+    if (p < 0)
+        return;
+    OrbitPool *pool = &pools[p];
+    pool->wanted++;
+
+    int slot = -1;
+    if (sat_slot[sat_index] >= 0)
+    {
+        int held = sat_slot[sat_index] % ORBIT_POOL_COUNT;
+        slot = sat_slot[sat_index] / ORBIT_POOL_COUNT;
+        if (held != p) /* new elements, other resolution class */
+        {
+            release_slot(&pools[held], slot);
+            slot = -1;
+        }
+    }
+    if (slot < 0)
+    {
+        if (pool->count == pool->capacity && !grow_pool(pool))
+            return;
+        slot = pool->count++;
+        pool->owner[slot] = sat_index;
+        pool->gen[slot] = 0;
+        sat_slot[sat_index] = slot * ORBIT_POOL_COUNT + p;
+        stats.resident++;
+    }
+    pool->last_added[slot] = frame_no;
+
+    if (pool->gen[slot] != sat->orbit_cache_gen && uploads_left > 0)
+    {
+        rlUpdateVertexBuffer(pool->vbo, sat->orbit_cache, sat->orbit_cache_resolution * (int)sizeof(Vector3),
+                             slot * pool->points * (int)sizeof(Vector3));
+        pool->gen[slot] = sat->orbit_cache_gen;
+        pool->resolution[slot] = sat->orbit_cache_resolution;
+        uploads_left--;
+        stats.uploads++;
+    }
+    /* out of upload budget the previous orbit of the same satellite still beats a gap */
+    if (pool->gen[slot] != 0 && pool->slot_points[slot] == 0.0f)
+    {
+        pool->slot_points[slot] = (float)pool->resolution[slot];
+        pool->drawn++;
+        stats.drawn++;
+    }
+}
+
+void OrbitLinesDraw(Color color)
+{
+    for (int p = 0; p < ORBIT_POOL_COUNT; p++)
+        compact_pool(&pools[p]);
+
+    stats.instances = 0;
+    if (stats.drawn == 0 || color.a == 0 || line_shader.id == rlGetShaderIdDefault())
+        return;
+    rlDrawRenderBatchActive();
+
+    /* BeginMode3D() left the camera in the modelview, same product the internal batch draws with */
+    Matrix mvp = MatrixMultiply(rlGetMatrixModelview(), rlGetMatrixProjection());
+    Vector2 viewport = {(float)GetRenderWidth(), (float)GetRenderHeight()};
+    float width = ORBIT_LINE_WIDTH;
+    int texture_slot = 0;
+    float line_color[4] = {color.r / 255.0f, color.g / 255.0f, color.b / 255.0f, color.a / 255.0f};
+
+    rlEnableShader(line_shader.id);
+    rlSetUniformMatrix(mvp_loc, mvp);
+    rlSetUniform(viewport_loc, &viewport, RL_SHADER_UNIFORM_VEC2, 1);
+    rlSetUniform(width_loc, &width, RL_SHADER_UNIFORM_FLOAT, 1);
+    rlSetUniform(color_loc, line_color, RL_SHADER_UNIFORM_VEC4, 1);
+    rlSetUniform(slot_points_loc, &texture_slot, RL_SHADER_UNIFORM_INT, 1);
+    rlActiveTextureSlot(0);
+
+    /* the quads face whichever way their segment runs on screen */
+    rlDisableBackfaceCulling();
+    for (int p = 0; p < ORBIT_POOL_COUNT; p++)
+    {
+        OrbitPool *pool = &pools[p];
+        if (pool->drawn == 0)
+            continue;
+        /* only the rows that hold live slots */
+        int rows = (pool->count + ORBIT_SLOT_CHUNK - 1) / ORBIT_SLOT_CHUNK;
+        rlUpdateTexture(pool->texture, 0, 0, ORBIT_SLOT_CHUNK, rows, PIXELFORMAT_UNCOMPRESSED_R32, pool->slot_points);
+        rlEnableTexture(pool->texture);
+        rlSetUniform(slot_size_loc, &pool->points, RL_SHADER_UNIFORM_INT, 1);
+        if (rlEnableVertexArray(pool->vao))
+        {
+            int instances = pool->count * pool->points - 1;
+            rlDrawVertexArrayInstanced(0, 6, instances);
+            rlDisableVertexArray();
+            stats.instances += instances;
+        }
+    }
+    rlEnableBackfaceCulling();
+    rlDisableTexture();
+    rlDisableShader();
+}
+
+OrbitLinesStats OrbitLinesGetStats(void)
+{
+    return stats;
+}
@@ -0,0 +1,28 @@
+#ifndef ORBITS_H
+#define ORBITS_H
+
+#include "raylib.h"
+#include <stddef.h>
+
+/* gpu copy of the satellites' orbit caches. every satellite with a cached orbit gets a fixed region of the vertex
+   buffer for its resolution class, refreshed whenever update_orbit_cache() baked it anew, and each class goes out in
+   one instanced draw. needs a GL 3.3 context, call after InitWindow() */
+void OrbitLinesInit(void);
+void OrbitLinesUnload(void);
+
+/* per frame, inside BeginMode3D(): Begin, Add for every satellites[] index whose cached orbit should show, Draw */
+void OrbitLinesBegin(void);
+void OrbitLinesAdd(int sat_index);
+void OrbitLinesDraw(Color color);
+
+typedef struct
+{
+    int resident; // orbits with a region in the buffer
+    int drawn;    // orbits in the last draw
+    int uploads;  // regions refreshed this frame
+    size_t bytes; // vertex buffers together
+    int instances; // segment instances the last draw ran through the vertex shader
+} OrbitLinesStats;
+OrbitLinesStats OrbitLinesGetStats(void);
+
+#endif // ORBITS_H
@@ -0,0 +1,616 @@
+#define _GNU_SOURCE
+#include "propagator.h"
+#include "astro.h"
+#include "threadpool.h"
+#include "types.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SAT_BATCH_FIELDS 34
+
+static void select_near_kernel(void);
+
+static size_t batch_bytes_total = 0; // every batch's buffers together, batches live on workers too so it's atomic
+
+static size_t sat_batch_bytes(int capacity)
+{
+    return (size_t)capacity * (sizeof(double) * SAT_BATCH_FIELDS + sizeof(int) * 2 + sizeof(SgpResonance));
+}
+
+size_t sat_batch_memory_bytes(void)
+{
+    return __sync_fetch_and_add(&batch_bytes_total, 0);
+}
+
+void sat_batch_init(SatBatch *batch)
+{
+    memset(batch, 0, sizeof(*batch));
+    select_near_kernel();
+}
+
+void sat_batch_free(SatBatch *batch)
+{
+    __sync_fetch_and_sub(&batch_bytes_total, sat_batch_bytes(batch->capacity));
+    free(batch->pool);
+    free(batch->isimp);
+    free(batch->sat_index);
+    free(batch->resonance);
+    memset(batch, 0, sizeof(*batch));
+}
+
+/* one big block for every double field, sliced up per coefficient so each one is contiguous */
+static bool sat_batch_reserve(SatBatch *batch, int n)
+{
+    if (n <= batch->capacity)
+        return true;
+
+    int cap = batch->capacity ? batch->capacity : 256;
+    while (cap < n)
+        cap *= 2;
+
+    double *pool = (double *)malloc(sizeof(double) * SAT_BATCH_FIELDS * cap);
+    int *isimp = (int *)malloc(sizeof(int) * cap);
+    int *sat_index = (int *)malloc(sizeof(int) * cap);
+    SgpResonance *resonance = (SgpResonance *)malloc(sizeof(SgpResonance) * cap);
+    if (!pool || !isimp || !sat_index || !resonance)
+    {
+        fprintf(stderr, "Failed to allocate propagation batch for %d satellites\n", n);
+        free(pool);
+        free(isimp);
+        free(sat_index);
+        free(resonance);
+        return false;
+    }
+
+    free(batch->pool);
+    free(batch->isimp);
+    free(batch->sat_index);
+    free(batch->resonance);
+    __sync_fetch_and_add(&batch_bytes_total, sat_batch_bytes(cap) - sat_batch_bytes(batch->capacity));
+    batch->pool = pool;
+    batch->isimp = isimp;
+    batch->sat_index = sat_index;
+    batch->resonance = resonance;
+    batch->capacity = cap;
+
+    double **fields[SAT_BATCH_FIELDS] = {
+        &batch->epoch_unix, &batch->mo,     &batch->mdot,      &batch->argpo,  &batch->argpdot, &batch->nodeo,      &batch->nodedot,
+        &batch->nodecf,     &batch->cc1,    &batch->bstar_cc4, &batch->bstar_cc5, &batch->t2cof, &batch->t3cof,     &batch->t4cof,
+        &batch->t5cof,      &batch->omgcof, &batch->eta,       &batch->xmcof,  &batch->delmo,   &batch->sinmao,     &batch->d2,
+        &batch->d3,         &batch->d4,     &batch->no_unkozai, &batch->ecco,  &batch->am0,     &batch->aycof,      &batch->xlcof,
+        &batch->con41,      &batch->x1mth2, &batch->x7thm1,    &batch->inclo,  &batch->sinio,   &batch->cosio,
+    };
+    for (int f = 0; f < SAT_BATCH_FIELDS; f++)
+        *fields[f] = pool + (size_t)f * cap;
+
+    return true;
+}
+
+static void sat_batch_store(SatBatch *batch, int lane, int sat_idx)
+{
+    const Satellite *sat = &satellites[sat_idx];
+    const struct elsetrec *s = &sat->satrec;
+
+    batch->sat_index[lane] = sat_idx;
+    batch->epoch_unix[lane] = sat->epoch_unix;
+    batch->mo[lane] = s->mo;
+    batch->mdot[lane] = s->mdot;
+    batch->argpo[lane] = s->argpo;
+    batch->argpdot[lane] = s->argpdot;
+    batch->nodeo[lane] = s->nodeo;
+    batch->nodedot[lane] = s->nodedot;
+    batch->nodecf[lane] = s->nodecf;
+    batch->cc1[lane] = s->cc1;
+    batch->bstar_cc4[lane] = s->bstar * s->cc4;
+    batch->bstar_cc5[lane] = s->bstar * s->cc5;
+    batch->t2cof[lane] = s->t2cof;
+    batch->t3cof[lane] = s->t3cof;
+    batch->t4cof[lane] = s->t4cof;
+    batch->t5cof[lane] = s->t5cof;
+    batch->omgcof[lane] = s->omgcof;
+    batch->eta[lane] = s->eta;
+    batch->xmcof[lane] = s->xmcof;
+    batch->delmo[lane] = s->delmo;
+    batch->sinmao[lane] = s->sinmao;
+    batch->d2[lane] = s->d2;
+    batch->d3[lane] = s->d3;
+    batch->d4[lane] = s->d4;
+    batch->no_unkozai[lane] = s->no_unkozai;
+    batch->ecco[lane] = s->ecco;
+    /* the pow() at the top of sgp4 only depends on init-time constants for near-earth orbits */
+    batch->am0[lane] = pow(s->xke / s->no_unkozai, 2.0 / 3.0);
+    batch->aycof[lane] = s->aycof;
+    batch->xlcof[lane] = s->xlcof;
+    batch->con41[lane] = s->con41;
+    batch->x1mth2[lane] = s->x1mth2;
+    batch->x7thm1[lane] = s->x7thm1;
+    batch->inclo[lane] = s->inclo;
+    batch->sinio[lane] = sin(s->inclo);
+    batch->cosio[lane] = cos(s->inclo);
+    batch->isimp[lane] = s->isimp;
+}
+
+/* copies the coefficients out of the (huge) Satellite structs, near-earth objects first */
+void sat_batch_build(SatBatch *batch, const int *sat_indices, int n)
+{
+    batch->count = 0;
+    batch->near_count = 0;
+    batch->catalog_rev = sat_catalog_rev;
+    if (n <= 0 || !sat_batch_reserve(batch, n))
+        return;
+
+    int lane = 0;
+    for (int i = 0; i < n; i++)
+    {
+        if (satellites[sat_indices[i]].satrec.method != 'd')
+            sat_batch_store(batch, lane++, sat_indices[i]);
+    }
+    batch->near_count = lane;
+
+    for (int i = 0; i < n; i++)
+    {
+        if (satellites[sat_indices[i]].satrec.method == 'd')
+        {
+            memset(&batch->resonance[lane], 0, sizeof(SgpResonance));
+            batch->sat_index[lane++] = sat_indices[i];
+        }
+    }
+    batch->count = lane;
+
+    if (batch->near_count > 0)
+    {
+        batch->j2 = satellites[batch->sat_index[0]].satrec.j2;
+        batch->radiusearthkm = satellites[batch->sat_index[0]].satrec.radiusearthkm;
+    }
+}
+
+/* near-earth branch of sgp4() from csgp4.h, position only, same operation order so results match bit for bit */
+static void propagate_near_lanes(const SatBatch *b, double current_unix, Vector3 *out, int start, int end)
+{
+    const double twopi = 2.0 * SGPPI;
+
+    for (int i = start; i < end; i++)
+    {
+        double t = (current_unix - b->epoch_unix[i]) / 60.0;
+
+        double xmdf = b->mo[i] + b->mdot[i] * t;
+        double argpdf = b->argpo[i] + b->argpdot[i] * t;
+        double nodedf = b->nodeo[i] + b->nodedot[i] * t;
+        double argpm = argpdf;
+        double mm = xmdf;
+        double t2 = t * t;
+        double nodem = nodedf + b->nodecf[i] * t2;
+        double tempa = 1.0 - b->cc1[i] * t;
+        double tempe = b->bstar_cc4[i] * t;
+        double templ = b->t2cof[i] * t2;
+
+        if (b->isimp[i] != 1)
+        {
+            double delomg = b->omgcof[i] * t;
+            double delmtemp = 1.0 + b->eta[i] * cos(xmdf);
+            double delm = b->xmcof[i] * (delmtemp * delmtemp * delmtemp - b->delmo[i]);
+            double temp = delomg + delm;
+            mm = xmdf + temp;
+            argpm = argpdf - temp;
+            double t3 = t2 * t;
+            double t4 = t3 * t;
+            tempa = tempa - b->d2[i] * t2 - b->d3[i] * t3 - b->d4[i] * t4;
+            tempe = tempe + b->bstar_cc5[i] * (sin(mm) - b->sinmao[i]);
+            templ = templ + b->t3cof[i] * t3 + t4 * (b->t4cof[i] + t * b->t5cof[i]);
+        }
+
+        double am = b->am0[i] * tempa * tempa;
+        double em = b->ecco[i] - tempe;
+        if (em < 1.0e-6)
+            em = 1.0e-6;
+        mm = mm + b->no_unkozai[i] * templ;
+        double xlm = mm + argpm + nodem;
+
+        nodem = fmod(nodem, twopi);
+        argpm = fmod(argpm, twopi);
+        xlm = fmod(xlm, twopi);
+        mm = fmod(xlm - argpm - nodem, twopi);
+
+        /* long period periodics */
+        double axnl = em * cos(argpm);
+        double temp = 1.0 / (am * (1.0 - em * em));
+        double aynl = em * sin(argpm) + temp * b->aycof[i];
+        double xl = mm + argpm + nodem + temp * b->xlcof[i] * axnl;
+
+        /* kepler */
+        double u = fmod(xl - nodem, twopi);
+        double eo1 = u;
+        double tem5 = 9999.9;
+        double sineo1 = 0.0, coseo1 = 0.0;
+        for (int ktr = 1; fabs(tem5) >= 1.0e-12 && ktr <= 10; ktr++)
+        {
+            sineo1 = sin(eo1);
+            coseo1 = cos(eo1);
+            tem5 = 1.0 - coseo1 * axnl - sineo1 * aynl;
+            tem5 = (u - aynl * coseo1 + axnl * sineo1 - eo1) / tem5;
+            if (fabs(tem5) >= 0.95)
+                tem5 = tem5 > 0.0 ? 0.95 : -0.95;
+            eo1 = eo1 + tem5;
+        }
+
+        double ecose = axnl * coseo1 + aynl * sineo1;
+        double esine = axnl * sineo1 - aynl * coseo1;
+        double el2 = axnl * axnl + aynl * aynl;
+        double pl = am * (1.0 - el2);
+        if (pl < 0.0)
+        {
+            /* sgp4 bails with a zeroed vector here, the frame update deactivates it */
+            out[i] = (Vector3){0.0f, 0.0f, 0.0f};
+            continue;
+        }
+
+        double rl = am * (1.0 - ecose);
+        double betal = sqrt(1.0 - el2);
+        temp = esine / (1.0 + betal);
+        double sinu = am / rl * (sineo1 - aynl - axnl * temp);
+        double cosu = am / rl * (coseo1 - axnl + aynl * temp);
+        double su = atan2(sinu, cosu);
+        double sin2u = (cosu + cosu) * sinu;
+        double cos2u = 1.0 - 2.0 * sinu * sinu;
+        temp = 1.0 / pl;
+        double temp1 = 0.5 * b->j2 * temp;
+        double temp2 = temp1 * temp;
+
+        double mrt = rl * (1.0 - 1.5 * temp2 * betal * b->con41[i]) + 0.5 * temp1 * b->x1mth2[i] * cos2u;
+        su = su - 0.25 * temp2 * b->x7thm1[i] * sin2u;
+        double xnode = nodem + 1.5 * temp2 * b->cosio[i] * sin2u;
+        double xinc = b->inclo[i] + 1.5 * temp2 * b->cosio[i] * b->sinio[i] * cos2u;
+
+        /* orientation vectors */
+        double sinsu = sin(su);
+        double cossu = cos(su);
+        double snod = sin(xnode);
+        double cnod = cos(xnode);
+        double sini = sin(xinc);
+        double cosi = cos(xinc);
+        double xmx = -snod * cosi;
+        double xmy = cnod * cosi;
+        double ux = xmx * sinsu + cnod * cossu;
+        double uy = xmy * sinsu + snod * cossu;
+        double uz = sini * sinsu;
+
+        double ro0 = (mrt * ux) * b->radiusearthkm;
+        double ro1 = (mrt * uy) * b->radiusearthkm;
+        double ro2 = (mrt * uz) * b->radiusearthkm;
+        out[i] = (Vector3){(float)ro0, (float)ro2, (float)(-ro1)};
+    }
+}
+
+/* vectorized copy of propagate_near_lanes(), 4 lanes on AVX2 and 2 on NEON. written once with gcc/clang vector
+   extensions, only sqrt/floor/trunc need real intrinsics. sin/cos/atan2 are cephes polynomials and fmod is
+   x - trunc(x/m)*m, so results are not bit exact with sgp4(). tolerance vs the scalar path: about 1e-8 km typical,
+   under 1e-6 km for healthy orbits within a month of epoch, and up to ~1 m on objects that are already decaying
+   through the atmosphere. all of that is below the float resolution of the Vector3 we hand out. */
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(_M_X64))
+#include <immintrin.h>
+#define SGP4_SIMD 1
+#define SGP4_LANES 4
+#define SGP4_SIMD_FN static inline __attribute__((always_inline, target("avx2")))
+#define SGP4_SIMD_ENTRY static __attribute__((target("avx2")))
+typedef double vd __attribute__((vector_size(32)));
+typedef long long vm __attribute__((vector_size(32)));
+SGP4_SIMD_FN vd v_sqrt(vd x) { return (vd)_mm256_sqrt_pd((__m256d)x); }
+SGP4_SIMD_FN vd v_floor(vd x) { return (vd)_mm256_round_pd((__m256d)x, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC); }
+SGP4_SIMD_FN vd v_trunc(vd x) { return (vd)_mm256_round_pd((__m256d)x, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC); }
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__aarch64__) || defined(_M_ARM64))
+#include <arm_neon.h>
+#define SGP4_SIMD 1
+#define SGP4_LANES 2
+#define SGP4_SIMD_FN static inline __attribute__((always_inline))
+#define SGP4_SIMD_ENTRY static
+typedef double vd __attribute__((vector_size(16)));
+typedef long long vm __attribute__((vector_size(16)));
+SGP4_SIMD_FN vd v_sqrt(vd x) { return (vd)vsqrtq_f64((float64x2_t)x); }
+SGP4_SIMD_FN vd v_floor(vd x) { return (vd)vrndmq_f64((float64x2_t)x); }
+SGP4_SIMD_FN vd v_trunc(vd x) { return (vd)vrndq_f64((float64x2_t)x); }
+#endif
+
+#ifdef SGP4_SIMD
+SGP4_SIMD_FN vd v_splat(double x)
+{
+    vd v;
+    for (int k = 0; k < SGP4_LANES; k++)
+        v[k] = x;
+    return v;
+}
+
+SGP4_SIMD_FN vd v_load(const double *p)
+{
+    vd v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+SGP4_SIMD_FN vd v_sel(vm mask, vd a, vd b) { return (vd)(((vm)a & mask) | ((vm)b & ~mask)); }
+SGP4_SIMD_FN vd v_abs(vd x) { return (vd)((vm)x & ~(vm)v_splat(-0.0)); }
+SGP4_SIMD_FN vd v_fmod(vd x, vd m) { return x - v_trunc(x / m) * m; }
+
+SGP4_SIMD_FN bool v_any(vm mask)
+{
+    for (int k = 0; k < SGP4_LANES; k++)
+        if (mask[k])
+            return true;
+    return false;
+}
+
+/* cephes sin/cos, reduced to an octant with a 3 part pi/4 so large mean anomalies stay accurate */
+SGP4_SIMD_FN void v_sincos(vd x, vd *out_sin, vd *out_cos)
+{
+    const vd zero = v_splat(0.0);
+    vm neg = x < zero;
+    vd ax = v_abs(x);
+    vd q = v_floor(ax * (4.0 / SGPPI));
+    q = q + (q - 2.0 * v_floor(q * 0.5)); /* odd octants round up */
+    vd j = q - 8.0 * v_floor(q * 0.125);
+    vd z = ((ax - q * 7.85398125648498535156E-1) - q * 3.77489470793079817668E-8) - q * 2.69515142907905952645E-15;
+    vd zz = z * z;
+
+    vd ps = 1.58962301576546568060E-10 * zz - 2.50507477628578072866E-8;
+    ps = ps * zz + 2.75573136213857245213E-6;
+    ps = ps * zz - 1.98412698295895385996E-4;
+    ps = ps * zz + 8.33333333332211858878E-3;
+    ps = ps * zz - 1.66666666666666307295E-1;
+    ps = z + z * zz * ps;
+
+    vd pc = -1.13585365213876817300E-11 * zz + 2.08757008419747316778E-9;
+    pc = pc * zz - 2.75573141792967388112E-7;
+    pc = pc * zz + 2.48015872888517045348E-5;
+    pc = pc * zz - 1.38888888888730564116E-3;
+    pc = pc * zz + 4.16666666666665929218E-2;
+    pc = 1.0 - 0.5 * zz + zz * zz * pc;
+
+    vm swap = (j == v_splat(2.0)) | (j == v_splat(6.0));
+    vd sv = v_sel(swap, pc, ps);
+    vd cv = v_sel(swap, ps, pc);
+    vm sin_neg = (j >= v_splat(4.0)) ^ neg;
+    vm cos_neg = (j == v_splat(2.0)) | (j == v_splat(4.0));
+    *out_sin = v_sel(sin_neg, -sv, sv);
+    *out_cos = v_sel(cos_neg, -cv, cv);
+}
+
+/* cephes atan, then the usual quadrant fixup */
+SGP4_SIMD_FN vd v_atan2(vd y, vd x)
+{
+    const vd zero = v_splat(0.0);
+    const double morebits = 6.123233995736765886130E-17;
+    vd a = y / x;
+    vm neg = a < zero;
+    a = v_abs(a);
+
+    vm big = a > v_splat(2.41421356237309504880);
+    vm mid = ~big & (a > v_splat(0.66));
+    vd base = v_sel(big, v_splat(SGPPI / 2.0), v_sel(mid, v_splat(SGPPI / 4.0), zero));
+    vd extra = v_sel(big, v_splat(morebits), v_sel(mid, v_splat(0.5 * morebits), zero));
+    vd xr = v_sel(big, -1.0 / a, v_sel(mid, (a - 1.0) / (a + 1.0), a));
+
+    vd z = xr * xr;
+    vd p = -8.750608600031904122785E-1 * z - 1.615753718733365076637E1;
+    p = p * z - 7.500855792314704667340E1;
+    p = p * z - 1.228866684490136173410E2;
+    p = p * z - 6.485021904942025371773E1;
+    vd q = z + 2.485846490142306297962E1;
+    q = q * z + 1.650270098316988542046E2;
+    q = q * z + 4.328810604912902668951E2;
+    q = q * z + 4.853903996359136964868E2;
+    q = q * z + 1.945506571482613964425E2;
+    z = z * p / q;
+    z = xr * z + xr + extra;
+    vd r = base + z;
+    r = v_sel(neg, -r, r);
+
+    vd w = v_sel(y < zero, v_splat(-SGPPI), v_splat(SGPPI));
+    return v_sel(x < zero, w + r, r);
+}
+
+SGP4_SIMD_ENTRY void propagate_near_lanes_simd(const SatBatch *b, double current_unix, Vector3 *out, int start, int end)
+{
+    const vd twopi = v_splat(2.0 * SGPPI);
+    const vd zero = v_splat(0.0);
+    const vd one = v_splat(1.0);
+
+    int i = start;
+    for (; i + SGP4_LANES <= end; i += SGP4_LANES)
+    {
+        vd t = (current_unix - v_load(b->epoch_unix + i)) / 60.0;
+
+        vd xmdf = v_load(b->mo + i) + v_load(b->mdot + i) * t;
+        vd argpdf = v_load(b->argpo + i) + v_load(b->argpdot + i) * t;
+        vd nodedf = v_load(b->nodeo + i) + v_load(b->nodedot + i) * t;
+        vd t2 = t * t;
+        vd nodem = nodedf + v_load(b->nodecf + i) * t2;
+        vd tempa = 1.0 - v_load(b->cc1 + i) * t;
+        vd tempe = v_load(b->bstar_cc4 + i) * t;
+        vd templ = v_load(b->t2cof + i) * t2;
+
+        /* the full drag terms get computed for every lane and masked off for isimp ones */
+        vd simp;
+        for (int k = 0; k < SGP4_LANES; k++)
+            simp[k] = b->isimp[i + k] == 1 ? 1.0 : 0.0;
+        vm full = simp == zero;
+
+        vd s_xmdf, c_xmdf;
+        v_sincos(xmdf, &s_xmdf, &c_xmdf);
+        vd delomg = v_load(b->omgcof + i) * t;
+        vd delmtemp = 1.0 + v_load(b->eta + i) * c_xmdf;
+        vd delm = v_load(b->xmcof + i) * (delmtemp * delmtemp * delmtemp - v_load(b->delmo + i));
+        vd temp = delomg + delm;
+        vd mm = v_sel(full, xmdf + temp, xmdf);
+        vd argpm = v_sel(full, argpdf - temp, argpdf);
+        vd t3 = t2 * t;
+        vd t4 = t3 * t;
+        vd s_mm, c_mm;
+        v_sincos(mm, &s_mm, &c_mm);
+        tempa = v_sel(full, tempa - v_load(b->d2 + i) * t2 - v_load(b->d3 + i) * t3 - v_load(b->d4 + i) * t4, tempa);
+        tempe = v_sel(full, tempe + v_load(b->bstar_cc5 + i) * (s_mm - v_load(b->sinmao + i)), tempe);
+        templ = v_sel(full, templ + v_load(b->t3cof + i) * t3 + t4 * (v_load(b->t4cof + i) + t * v_load(b->t5cof + i)), templ);
+
+        vd am = v_load(b->am0 + i) * tempa * tempa;
+        vd em = v_load(b->ecco + i) - tempe;
+        em = v_sel(em < v_splat(1.0e-6), v_splat(1.0e-6), em);
+        mm = mm + v_load(b->no_unkozai + i) * templ;
+        vd xlm = mm + argpm + nodem;
+
+        nodem = v_fmod(nodem, twopi);
+        argpm = v_fmod(argpm, twopi);
+        xlm = v_fmod(xlm, twopi);
+        mm = v_fmod(xlm - argpm - nodem, twopi);
+
+        vd s_argpm, c_argpm;
+        v_sincos(argpm, &s_argpm, &c_argpm);
+        vd axnl = em * c_argpm;
+        temp = 1.0 / (am * (1.0 - em * em));
+        vd aynl = em * s_argpm + temp * v_load(b->aycof + i);
+        vd xl = mm + argpm + nodem + temp * v_load(b->xlcof + i) * axnl;
+
+        /* kepler, lanes drop out of the update once they converge */
+        vd u = v_fmod(xl - nodem, twopi);
+        vd eo1 = u;
+        vd tem5 = v_splat(9999.9);
+        vd sineo1 = zero, coseo1 = zero;
+        vm iterating = (vm)(zero == zero);
+        for (int ktr = 1; ktr <= 10; ktr++)
+        {
+            iterating = iterating & (v_abs(tem5) >= v_splat(1.0e-12));
+            if (!v_any(iterating))
+                break;
+            vd s, c;
+            v_sincos(eo1, &s, &c);
+            sineo1 = v_sel(iterating, s, sineo1);
+            coseo1 = v_sel(iterating, c, coseo1);
+            vd step = 1.0 - coseo1 * axnl - sineo1 * aynl;
+            step = (u - aynl * coseo1 + axnl * sineo1 - eo1) / step;
+            step = v_sel(v_abs(step) >= v_splat(0.95), v_sel(step > zero, v_splat(0.95), v_splat(-0.95)), step);
+            tem5 = v_sel(iterating, step, tem5);
+            eo1 = v_sel(iterating, eo1 + step, eo1);
+        }
+
+        vd ecose = axnl * coseo1 + aynl * sineo1;
+        vd esine = axnl * sineo1 - aynl * coseo1;
+        vd el2 = axnl * axnl + aynl * aynl;
+        vd pl = am * (1.0 - el2);
+        vm decayed = pl < zero;
+
+        vd rl = am * (1.0 - ecose);
+        vd betal = v_sqrt(1.0 - el2);
+        temp = esine / (1.0 + betal);
+        vd sinu = am / rl * (sineo1 - aynl - axnl * temp);
+        vd cosu = am / rl * (coseo1 - axnl + aynl * temp);
+        vd su = v_atan2(sinu, cosu);
+        vd sin2u = (cosu + cosu) * sinu;
+        vd cos2u = 1.0 - 2.0 * sinu * sinu;
+        temp = 1.0 / pl;
+        vd temp1 = 0.5 * b->j2 * temp;
+        vd temp2 = temp1 * temp;
+
+        vd cosio = v_load(b->cosio + i);
+        vd mrt = rl * (1.0 - 1.5 * temp2 * betal * v_load(b->con41 + i)) + 0.5 * temp1 * v_load(b->x1mth2 + i) * cos2u;
+        su = su - 0.25 * temp2 * v_load(b->x7thm1 + i) * sin2u;
+        vd xnode = nodem + 1.5 * temp2 * cosio * sin2u;
+        vd xinc = v_load(b->inclo + i) + 1.5 * temp2 * cosio * v_load(b->sinio + i) * cos2u;
+
+        vd sinsu, cossu, snod, cnod, sini, cosi;
+        v_sincos(su, &sinsu, &cossu);
+        v_sincos(xnode, &snod, &cnod);
+        v_sincos(xinc, &sini, &cosi);
+        vd xmx = -snod * cosi;
+        vd xmy = cnod * cosi;
+        vd ux = xmx * sinsu + cnod * cossu;
+        vd uy = xmy * sinsu + snod * cossu;
+        vd uz = sini * sinsu;
+
+        vd ro0 = v_sel(decayed, zero, (mrt * ux) * b->radiusearthkm);
+        vd ro1 = v_sel(decayed, zero, (mrt * uy) * b->radiusearthkm);
+        vd ro2 = v_sel(decayed, zero, (mrt * uz) * b->radiusearthkm);
+        for (int k = 0; k < SGP4_LANES; k++)
+            out[i + k] = (Vector3){(float)ro0[k], (float)ro2[k], (float)(-ro1[k])};
+    }
+
+    /* ragged tail */
+    propagate_near_lanes(b, current_unix, out, i, end);
+}
+#endif
+
+typedef void (*NearKernelFn)(const SatBatch *b, double current_unix, Vector3 *out, int start, int end);
+static NearKernelFn near_kernel = NULL;
+static const char *near_kernel_name = "Scalar";
+
+/* picks the widest kernel the cpu can actually run, once */
+static void select_near_kernel(void)
+{
+    if (near_kernel)
+        return;
+    NearKernelFn kernel = propagate_near_lanes;
+    const char *name = "Scalar";
+#if defined(SGP4_SIMD) && SGP4_LANES == 4
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        kernel = propagate_near_lanes_simd;
+        name = "AVX2 x4";
+    }
+#elif defined(SGP4_SIMD)
+    kernel = propagate_near_lanes_simd; /* NEON is baseline on aarch64 */
+    name = "NEON x2";
+#endif
+    /* batches get built on worker threads too, whoever gets here first publishes the choice */
+    if (__sync_bool_compare_and_swap(&near_kernel, (NearKernelFn)NULL, kernel))
+        near_kernel_name = name;
+}
+
+const char *propagator_kernel_name(void)
+{
+    select_near_kernel();
+    return near_kernel_name;
+}
+
+void propagate_batch_range(const SatBatch *batch, double current_unix, Vector3 *out, int start, int end)
+{
+    if (end > batch->count)
+        end = batch->count;
+
+    int near_end = end < batch->near_count ? end : batch->near_count;
+    if (start < near_end)
+        near_kernel(batch, current_unix, out, start, near_end);
+
+    /* deep-space leftovers keep using the full scalar propagator, with the lane's own integrator state */
+    for (int i = start > batch->near_count ? start : batch->near_count; i < end; i++)
+        out[i] = calculate_position_r(&satellites[batch->sat_index[i]], current_unix, &batch->resonance[i]);
+}
+
+void propagate_batch(const SatBatch *batch, double current_unix, Vector3 *out, int n)
+{
+    propagate_batch_range(batch, current_unix, out, 0, n);
+}
+
+typedef struct
+{
+    const SatBatch *batch;
+    double current_unix;
+    Vector3 *out;
+} BatchJob;
+
+static void batch_job(void *arg, int start, int end)
+{
+    const BatchJob *job = (const BatchJob *)arg;
+    propagate_batch_range(job->batch, job->current_unix, job->out, start, end);
+}
+
+void propagate_batch_parallel(const SatBatch *batch, double current_unix, Vector3 *out, int n)
+{
+    if (n > batch->count)
+        n = batch->count;
+
+    /* satrecs are only read here, a lane writes just its own out[] slot and its own resonance[] entry of the batch, so
+       chunks never overlap.
+       chunks are a multiple of the widest simd width so only the very last one has a scalar tail. */
+    BatchJob job = {batch, current_unix, out};
+    WorkerPoolRun(batch_job, &job, n, PROPAGATE_MIN_CHUNK);
+}
@@ -0,0 +1,56 @@
+#ifndef PROPAGATOR_H
+#define PROPAGATOR_H
+
+#include "types.h"
+
+/* structure-of-arrays copy of the near-earth sgp4 coefficients for a set of satellites.
+   lanes [0, near_count) run through the batch kernel, [near_count, count) are deep-space
+   objects that still go through the regular scalar sgp4 path. the batch never writes to
+   satellites[], so separate batches can propagate the same objects on different threads. */
+typedef struct
+{
+    int count;
+    int near_count;
+    int capacity;
+    unsigned int catalog_rev; // sat_catalog_rev at build time
+    int *sat_index;           // lane -> satellites[] slot
+
+    double *epoch_unix;
+    double *mo, *mdot;
+    double *argpo, *argpdot;
+    double *nodeo, *nodedot, *nodecf;
+    double *cc1, *bstar_cc4, *bstar_cc5;
+    double *t2cof, *t3cof, *t4cof, *t5cof;
+    double *omgcof, *eta, *xmcof, *delmo, *sinmao;
+    double *d2, *d3, *d4;
+    double *no_unkozai, *ecco, *am0;
+    double *aycof, *xlcof, *con41, *x1mth2, *x7thm1;
+    double *inclo, *sinio, *cosio;
+    int *isimp;
+    SgpResonance *resonance; // per lane integrator state for the deep-space lanes, owned by the batch
+
+    double j2;
+    double radiusearthkm;
+
+    double *pool;
+} SatBatch;
+
+void sat_batch_init(SatBatch *batch);
+void sat_batch_free(SatBatch *batch);
+void sat_batch_build(SatBatch *batch, const int *sat_indices, int n);
+/* what the buffers of every batch that currently exists take together */
+size_t sat_batch_memory_bytes(void);
+
+/* propagates the first n lanes of the batch, out[lane] gets the same ECI (draw axes) position calculate_position() would return.
+   deep-space lanes advance the batch's own resonance state, so one batch per thread */
+void propagate_batch(const SatBatch *batch, double current_unix, Vector3 *out, int n);
+void propagate_batch_range(const SatBatch *batch, double current_unix, Vector3 *out, int start, int end);
+
+/* same as propagate_batch but spread over the worker pool, lanes smaller than this stay on one thread */
+#define PROPAGATE_MIN_CHUNK 64
+void propagate_batch_parallel(const SatBatch *batch, double current_unix, Vector3 *out, int n);
+
+/* which near-earth kernel the runtime dispatch picked, for the stats overlay */
+const char *propagator_kernel_name(void);
+
+#endif // PROPAGATOR_H
@@ -0,0 +1,303 @@
+#define _GNU_SOURCE
+#include "threadpool.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32) || defined(_WIN64)
+#define WIN32_LEAN_AND_MEAN
+#define NOGDI
+#define NOUSER
+typedef struct tagMSG *LPMSG;
+#include <process.h>
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#define MAX_POOL_THREADS 32
+
+/* worker threads sleep on cv_work until the generation changes, grab chunks off next_start,
+   and the last one out signals cv_done. the caller chews through chunks too while it waits. */
+static struct
+{
+    int thread_count; // workers, not counting the caller
+    bool shutdown;
+    unsigned int generation;
+
+    WorkerJob job;
+    void *arg;
+    int count;
+    int chunk;
+    volatile int next_start;
+    int pending;
+    volatile int busy;
+
+#if defined(_WIN32) || defined(_WIN64)
+    CRITICAL_SECTION lock;
+    CONDITION_VARIABLE cv_work;
+    CONDITION_VARIABLE cv_done;
+    HANDLE threads[MAX_POOL_THREADS];
+#else
+    pthread_mutex_t lock;
+    pthread_cond_t cv_work;
+    pthread_cond_t cv_done;
+    pthread_t threads[MAX_POOL_THREADS];
+#endif
+} pool;
+
+#if defined(_WIN32) || defined(_WIN64)
+#define POOL_LOCK() EnterCriticalSection(&pool.lock)
+#define POOL_UNLOCK() LeaveCriticalSection(&pool.lock)
+#define POOL_WAIT(cv) SleepConditionVariableCS(&(cv), &pool.lock, INFINITE)
+#define POOL_SIGNAL(cv) WakeConditionVariable(&(cv))
+#define POOL_BROADCAST(cv) WakeAllConditionVariable(&(cv))
+#else
+#define POOL_LOCK() pthread_mutex_lock(&pool.lock)
+#define POOL_UNLOCK() pthread_mutex_unlock(&pool.lock)
+#define POOL_WAIT(cv) pthread_cond_wait(&(cv), &pool.lock)
+#define POOL_SIGNAL(cv) pthread_cond_signal(&(cv))
+#define POOL_BROADCAST(cv) pthread_cond_broadcast(&(cv))
+#endif
+
+static int CpuCount(void)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (int)info.dwNumberOfProcessors;
+#else
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+#endif
+}
+
+static void RunChunks(void)
+{
+    for (;;)
+    {
+        int start = __sync_fetch_and_add(&pool.next_start, pool.chunk);
+        if (start >= pool.count)
+            break;
+        int end = start + pool.chunk;
+        if (end > pool.count)
+            end = pool.count;
+        pool.job(pool.arg, start, end);
+    }
+}
+
+static void WorkerLoop(void)
+{
+    unsigned int seen = 0;
+    for (;;)
+    {
+        POOL_LOCK();
+        while (!pool.shutdown && pool.generation == seen)
+            POOL_WAIT(pool.cv_work);
+        if (pool.shutdown)
+        {
+            POOL_UNLOCK();
+            return;
+        }
+        seen = pool.generation;
+        POOL_UNLOCK();
+
+        RunChunks();
+
+        POOL_LOCK();
+        if (--pool.pending == 0)
+            POOL_SIGNAL(pool.cv_done);
+        POOL_UNLOCK();
+    }
+}
+
+#if defined(_WIN32) || defined(_WIN64)
+static unsigned __stdcall WorkerThreadWin(void *arg)
+{
+    (void)arg;
+    WorkerLoop();
+    return 0;
+}
+#else
+static void *WorkerThread(void *arg)
+{
+    (void)arg;
+    WorkerLoop();
+    return NULL;
+}
+#endif
+
+void WorkerPoolInit(int thread_count)
+{
+    if (pool.thread_count > 0)
+        return;
+
+    if (thread_count <= 0)
+        thread_count = CpuCount();
+    if (thread_count > MAX_POOL_THREADS + 1)
+        thread_count = MAX_POOL_THREADS + 1;
+
+    memset(&pool, 0, sizeof(pool));
+#if defined(_WIN32) || defined(_WIN64)
+    InitializeCriticalSection(&pool.lock);
+    InitializeConditionVariable(&pool.cv_work);
+    InitializeConditionVariable(&pool.cv_done);
+#else
+    pthread_mutex_init(&pool.lock, NULL);
+    pthread_cond_init(&pool.cv_work, NULL);
+    pthread_cond_init(&pool.cv_done, NULL);
+#endif
+
+    /* the calling thread always helps out, so spawn one less */
+    for (int i = 0; i < thread_count - 1; i++)
+    {
+#if defined(_WIN32) || defined(_WIN64)
+        uintptr_t h = _beginthreadex(NULL, 0, WorkerThreadWin, NULL, 0, NULL);
+        if (h == 0)
+            break;
+        pool.threads[pool.thread_count++] = (HANDLE)h;
+#else
+        if (pthread_create(&pool.threads[pool.thread_count], NULL, WorkerThread, NULL) != 0)
+            break;
+        pool.thread_count++;
+#endif
+    }
+
+    fprintf(stderr, "INFO: worker pool running with %d threads\n", pool.thread_count + 1);
+}
+
+void WorkerPoolShutdown(void)
+{
+    if (pool.thread_count == 0)
+        return;
+
+    POOL_LOCK();
+    pool.shutdown = true;
+    POOL_BROADCAST(pool.cv_work);
+    POOL_UNLOCK();
+
+    for (int i = 0; i < pool.thread_count; i++)
+    {
+#if defined(_WIN32) || defined(_WIN64)
+        WaitForSingleObject(pool.threads[i], INFINITE);
+        CloseHandle(pool.threads[i]);
+#else
+        pthread_join(pool.threads[i], NULL);
+#endif
+    }
+    pool.thread_count = 0;
+}
+
+int WorkerPoolThreadCount(void)
+{
+    return pool.thread_count + 1;
+}
+
+void WorkerPoolRun(WorkerJob job, void *arg, int count, int min_chunk)
+{
+    if (count <= 0)
+        return;
+    if (min_chunk < 1)
+        min_chunk = 1;
+
+    /* not worth waking anybody up, or somebody else owns the pool right now */
+    if (pool.thread_count == 0 || count <= min_chunk || __sync_lock_test_and_set(&pool.busy, 1))
+    {
+        job(arg, 0, count);
+        return;
+    }
+
+    /* a few chunks per thread so uneven work (deep-space objects) still balances out */
+    int chunk = count / ((pool.thread_count + 1) * 4);
+    if (chunk < min_chunk)
+        chunk = min_chunk;
+    chunk = (chunk + min_chunk - 1) / min_chunk * min_chunk;
+
+    POOL_LOCK();
+    pool.job = job;
+    pool.arg = arg;
+    pool.count = count;
+    pool.chunk = chunk;
+    pool.next_start = 0;
+    pool.pending = pool.thread_count;
+    pool.generation++;
+    POOL_BROADCAST(pool.cv_work);
+    POOL_UNLOCK();
+
+    RunChunks();
+
+    POOL_LOCK();
+    while (pool.pending > 0)
+        POOL_WAIT(pool.cv_done);
+    POOL_UNLOCK();
+
+    __sync_lock_release(&pool.busy);
+}
+
+struct BackgroundThread
+{
+    void (*fn)(void *arg);
+    void *arg;
+#if defined(_WIN32) || defined(_WIN64)
+    HANDLE handle;
+#else
+    pthread_t handle;
+#endif
+};
+
+#if defined(_WIN32) || defined(_WIN64)
+static unsigned __stdcall BackgroundThreadMainWin(void *arg)
+{
+    BackgroundThread *thread = (BackgroundThread *)arg;
+    thread->fn(thread->arg);
+    return 0;
+}
+#else
+static void *BackgroundThreadMain(void *arg)
+{
+    BackgroundThread *thread = (BackgroundThread *)arg;
+    thread->fn(thread->arg);
+    return NULL;
+}
+#endif
+
+BackgroundThread *BackgroundThreadStart(void (*fn)(void *arg), void *arg)
+{
+    BackgroundThread *thread = (BackgroundThread *)malloc(sizeof(BackgroundThread));
+    if (!thread)
+        return NULL;
+    thread->fn = fn;
+    thread->arg = arg;
+
+#if defined(_WIN32) || defined(_WIN64)
+    uintptr_t h = _beginthreadex(NULL, 0, BackgroundThreadMainWin, thread, 0, NULL);
+    if (h == 0)
+    {
+        free(thread);
+        return NULL;
+    }
+    thread->handle = (HANDLE)h;
+#else
+    if (pthread_create(&thread->handle, NULL, BackgroundThreadMain, thread) != 0)
+    {
+        free(thread);
+        return NULL;
+    }
+#endif
+    return thread;
+}
+
+void BackgroundThreadJoin(BackgroundThread *thread)
+{
+    if (!thread)
+        return;
+#if defined(_WIN32) || defined(_WIN64)
+    WaitForSingleObject(thread->handle, INFINITE);
+    CloseHandle(thread->handle);
+#else
+    pthread_join(thread->handle, NULL);
+#endif
+    free(thread);
+}
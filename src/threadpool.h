@@ -0,0 +1,21 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+/* a job gets called with [start, end) slices of its range, from the pool threads and the caller */
+typedef void (*WorkerJob)(void *arg, int start, int end);
+
+/* thread_count <= 0 picks one per core; 1 keeps everything on the calling thread */
+void WorkerPoolInit(int thread_count);
+void WorkerPoolShutdown(void);
+int WorkerPoolThreadCount(void);
+
+/* splits [0, count) into chunks of at least min_chunk and blocks until every chunk ran.
+   if the pool is already busy with another caller's job the range just runs inline. */
+void WorkerPoolRun(WorkerJob job, void *arg, int count, int min_chunk);
+
+/* one-off joinable thread for long jobs that would otherwise sit on the pool (and the frame update) for seconds */
+typedef struct BackgroundThread BackgroundThread;
+BackgroundThread *BackgroundThreadStart(void (*fn)(void *arg), void *arg);
+void BackgroundThreadJoin(BackgroundThread *thread); // also frees it
+
+#endif // THREADPOOL_H
@@ -8,7 +8,8 @@
 #include <sys/types.h>
 
 // basic limits and math constants
-#define MAX_SATELLITES 15000
+#define CATALOG_RESERVE_SLOTS (1 << 19) // address space per catalog, ~10x the public catalog with debris
+#define CATALOG_CHUNK_SLOTS 4096       // committed this many at a time as a catalog fills
 #define MAX_MARKERS 100
 #define EARTH_RADIUS_KM 6371.0f
 #define MOON_RADIUS_KM 1737.4f
@@ -18,9 +19,32 @@
 #define ORBIT_CACHE_SIZE 361
 #define MAX_CUSTOM_TLE_SOURCES 20
 
-// keeps track of satellite data
+// deep-space resonance integrator state that sgp4 normally keeps inside the elset.
+// whoever propagates owns one of these so callers on other threads or at other times don't trample it
 typedef struct
 {
+    double atime;
+    double xli;
+    double xni;
+} SgpResonance;
+
+// the part of a satellite every frame touches. these live in their own array next to the slots (sat_hot[i] goes with
+// satellites[i]) so the per-frame passes stride 16 bytes instead of a whole Satellite
+typedef struct
+{
+    Vector3 current_pos;
+    bool is_active;
+} SatHot;
+
+// keeps track of satellite data, the cold rest of a slot. the orbit cache lives out of line and only exists for
+// satellites that have drawn an orbit
+typedef struct
+{
+    bool orbit_cached;
+    int orbit_cache_resolution;  // How many points r valid
+    Vector3 *orbit_cache;        // ORBIT_CACHE_SIZE points once allocated, owned by the slot (see release_orbit_cache())
+    unsigned int orbit_cache_gen; // new value every update_orbit_cache(), how the gpu copy in orbits.c spots stale orbits
+
     char name[32];
     char norad_id[6];
     char intl_designator[8];
@@ -33,16 +57,12 @@ typedef struct
     double mean_anomaly;
     double mean_motion;
     double semi_major_axis;
-    Vector3 current_pos;
 
-    struct elsetrec satrec;
+    struct elsetrec satrec; // read-only after init, sgp4 runs on scratch copies
+    SgpResonance resonance; // integrator state for plain calculate_position() calls (main thread)
 
-    Vector3 orbit_cache[ORBIT_CACHE_SIZE];
-    int orbit_cache_resolution;  // How many points r valid
     Vector3 cached_orbit_base_pos;  // Position when cache was last calculated
     double cached_orbit_epoch;  // Epoch when cache was last calculated
-    bool orbit_cached;
-    bool is_active;
 } Satellite;
 
 typedef struct
@@ -60,8 +80,10 @@ typedef struct
     bool selected;
 } CustomTLESource;
 
-extern Satellite satellites[MAX_SATELLITES];
+extern Satellite *satellites; // grows in place (see grow_catalog()), replaced wholesale by swap_catalog()
+extern SatHot *sat_hot;       // same slots as satellites[], moves along with it
 extern int sat_count;
+extern unsigned int sat_catalog_rev; // bumped whenever satellites[] contents change
 
 extern Marker home_location;
 extern Marker markers[MAX_MARKERS];
@@ -79,7 +101,12 @@ typedef struct
     float ui_scale;
     float earth_rotation_offset;
     float orbits_to_draw;
+    float pass_days_all;                   // pass search window in days, all satellites
+    float pass_days_targeted;              // pass search window in days, selected satellite only
     float orbit_cache_drift_threshold_km;  // Recalculate cache if satellite drifts more than this (default 50 km)
+    int propagation_threads;               // worker threads for propagation, 0 = one per core
+    int pull_concurrency;                  // TLE sources downloaded at once
+    int pull_timeout_s;                    // give up on a TLE source after this many seconds
     bool show_clouds;
     bool show_night_lights;
     bool show_markers;
@@ -88,6 +115,8 @@ typedef struct
     bool show_slant_range;
     bool show_scattering;
     bool hint_vsync;
+    bool pass_search_fixed_step; // old fixed 1/4 minute pass search instead of the adaptive one
+    bool pass_search_report;     // log sgp4 call counts and timing of every pass search
     bool show_skybox;
     bool show_first_run_dialog;
     bool reload_theme;
@@ -1,11 +1,15 @@
 /* headers and defines */
 #define _GNU_SOURCE
 #include "ui.h"
+#include "arena.h"
+#include "orbits.h"
 #include "astro.h"
+#include "propagator.h"
 #include "rotator.h"
 #include <ctype.h>
 #include <math.h>
 #include <raymath.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -178,6 +182,39 @@ enum { PULL_IDLE = 0, PULL_BUSY, PULL_DONE, PULL_ERROR };
 static volatile int pull_state = PULL_IDLE;
 static volatile bool pull_partial = false;
 static AppConfig *pull_cfg = NULL;
+
+/* one selected source of a pull, in the order it goes into data.tle. the stats outlive the pull for the TLE manager */
+enum { PULL_GROUP_RETLECTOR = 0, PULL_GROUP_CELESTRAK, PULL_GROUP_CUSTOM };
+typedef struct
+{
+    int group;
+    int index;
+    char url[256];
+    FILE *spool;       // body on its way into the pull cache
+    TleStream *stream; // satellites parsed out of the body so far, installed once the pull is done
+    long status;       // of the response being received, bodies of anything but a 200 are dropped
+    char etag[128];          // validators of the cached body, sent along so an unchanged source answers 304
+    char last_modified[64];
+    char new_etag[128];      // validators of this response, stored with the body on a 200
+    char new_last_modified[64];
+    struct curl_slist *headers;
+    bool done;
+    bool ok;
+    bool not_modified; // body came out of the pull cache
+    long http_code;
+    CURLcode result;
+    size_t bytes;
+    double latency_ms;
+} PullJob;
+
+#define MAX_PULL_JOBS (NUM_RETLECTOR_SOURCES + 25 + MAX_CUSTOM_TLE_SOURCES)
+static PullJob pull_jobs[MAX_PULL_JOBS]; // only touched by the pull thread while pull_state is PULL_BUSY
+static int pull_job_count = 0;
+static volatile int pull_job_total = 0;
+static volatile int pull_jobs_done = 0;
+static Satellite *pull_catalog = NULL; // next catalog, built by the pull thread and swapped in by FinishPullIfDone()
+static int pull_catalog_count = 0;
+static TleStaging pull_staging; // what the bodies parse into while they arrive, becomes pull_catalog once it's in order
 #if defined(_WIN32) || defined(_WIN64)
 static HANDLE pull_thread = NULL;
 #else
@@ -194,6 +231,10 @@ static double locked_pass_aos = 0.0;
 static double locked_pass_los = 0.0;
 static char text_min_el[8] = "0";
 static bool edit_min_el = false;
+static char text_pass_days[8] = "";
+static bool edit_pass_days = false;
+static int *valid_passes = NULL; // passes[] indices that clear the min elevation, rebuilt every frame
+static int valid_passes_cap = 0;
 
 static float hw_x = 100.0f, hw_y = 250.0f;
 static float sw_x = 100.0f, sw_y = 250.0f;
@@ -446,41 +487,178 @@ static void LoadTLEState(AppConfig *cfg)
     if (data_tle_epoch == -1) data_tle_epoch = 0;
 }
 
-struct MemoryStruct {
-    char *memory;
-    size_t size;
-};
+/* --- per-url pull cache: the last good body of every source plus its ETag/Last-Modified, so unchanged sources
+   come back as a 304 instead of the whole catalog again (celestrak asks for exactly that) --- */
+#define TLE_CACHE_DIR "tle_cache"
 
-static size_t write_memory_callback(void *contents, size_t size, size_t nmemb, void *userp)
+static void PullCachePath(const char *url, const char *ext, char *out, size_t size)
 {
-    size_t realsize = size * nmemb;
-    struct MemoryStruct *mem = (struct MemoryStruct *)userp;
+    unsigned long long h = 1469598103934665603ULL;
+    for (const unsigned char *p = (const unsigned char *)url; *p; p++)
+        h = (h ^ *p) * 1099511628211ULL;
+    snprintf(out, size, TLE_CACHE_DIR "/%016llx.%s", h, ext);
+}
 
-    char *ptr = realloc(mem->memory, mem->size + realsize + 1);
-    if (!ptr) return 0; // out of memory
+/* validators are only worth sending if the body they belong to is still around */
+static void LoadPullCacheMeta(PullJob *job)
+{
+    char meta_path[256], body_path[256];
+    PullCachePath(job->url, "meta", meta_path, sizeof(meta_path));
+    PullCachePath(job->url, "tle", body_path, sizeof(body_path));
+    if (!FileExists(body_path)) return;
+
+    FILE *f = fopen(meta_path, "r");
+    if (!f) return;
+    char line[512];
+    bool same_url = false;
+    while (fgets(line, sizeof(line), f))
+    {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (strncmp(line, "url ", 4) == 0) same_url = strcmp(line + 4, job->url) == 0;
+        else if (strncmp(line, "etag ", 5) == 0) strncpy(job->etag, line + 5, sizeof(job->etag) - 1);
+        else if (strncmp(line, "last_modified ", 14) == 0) strncpy(job->last_modified, line + 14, sizeof(job->last_modified) - 1);
+    }
+    fclose(f);
+    if (!same_url) job->etag[0] = job->last_modified[0] = '\0';
+}
 
-    mem->memory = ptr;
-    memcpy(&(mem->memory[mem->size]), contents, realsize);
-    mem->size += realsize;
-    mem->memory[mem->size] = 0;
+/* where a body lands while it's still coming in, per job so two sources with the same url can't collide */
+static void PullSpoolPath(const PullJob *job, char *out, size_t size)
+{
+    char path[256];
+    PullCachePath(job->url, "tle", path, sizeof(path));
+    snprintf(out, size, "%s.%d-%d.part", path, job->group, job->index);
+}
 
+static bool OpenPullSpool(PullJob *job)
+{
+    char path[280];
+    PullSpoolPath(job, path, sizeof(path));
+    if (!job->stream) job->stream = tle_stream_create(job->url, &pull_staging);
+    if (!job->spool) job->spool = fopen(path, "wb");
+    return job->spool && job->stream;
+}
+
+/* the old meta goes before the body is replaced and the new one only lands after it, both through a rename: validators
+   on disk always describe the body next to them. no meta just means the next pull asks for the whole body again */
+static bool SavePullCache(PullJob *job)
+{
+    char body_path[256], spool_path[280], meta_path[256], meta_tmp[280];
+    PullCachePath(job->url, "tle", body_path, sizeof(body_path));
+    PullSpoolPath(job, spool_path, sizeof(spool_path));
+    PullCachePath(job->url, "meta", meta_path, sizeof(meta_path));
+    snprintf(meta_tmp, sizeof(meta_tmp), "%s.tmp", meta_path);
+
+    FILE *f = fopen(meta_tmp, "w");
+    bool meta_ok = f && fprintf(f, "url %s\netag %s\nlast_modified %s\n", job->url, job->new_etag, job->new_last_modified) > 0;
+    if (f && fclose(f) != 0) meta_ok = false;
+
+    remove(meta_path);
+    if (!replace_file(spool_path, body_path))
+    {
+        remove(meta_tmp);
+        return false;
+    }
+    if (!meta_ok || !replace_file(meta_tmp, meta_path)) remove(meta_tmp);
+    return true;
+}
+
+/* copies a source's cached body to out (NULL: into its parser instead), chunk by chunk */
+static bool CopyPullCacheBody(PullJob *job, FILE *out)
+{
+    char path[256];
+    PullCachePath(job->url, "tle", path, sizeof(path));
+    FILE *f = fopen(path, "rb");
+    if (!f) return false;
+    if (!out && !job->stream) job->stream = tle_stream_create(job->url, &pull_staging);
+
+    static char chunk[64 * 1024]; /* only ever used by the pull thread */
+    size_t n;
+    bool ok = out || job->stream;
+    while (ok && (n = fread(chunk, 1, sizeof(chunk), f)) > 0)
+    {
+        if (out) ok = fwrite(chunk, 1, n, out) == n;
+        else tle_stream_feed(job->stream, chunk, n);
+    }
+    if (ferror(f)) ok = false;
+    fclose(f);
+    return ok;
+}
+
+/* curl hands the body over in pieces: each goes to the spool file and straight through the parser, nothing is buffered */
+static size_t pull_write_callback(void *contents, size_t size, size_t nmemb, void *userp)
+{
+    size_t realsize = size * nmemb;
+    PullJob *job = (PullJob *)userp;
+    if (job->status != 200) return realsize; /* error pages aren't TLEs */
+    if (!OpenPullSpool(job) || fwrite(contents, 1, realsize, job->spool) != realsize) return 0;
+    tle_stream_feed(job->stream, (const char *)contents, realsize);
+    job->bytes += realsize;
     return realsize;
 }
 
-static bool DownloadTLESource(CURL *curl, const char *url, FILE *out)
+/* "Name: value\r\n" -> value, if the header is the one asked for (names are case insensitive) */
+static bool CopyHeaderValue(const char *line, size_t len, const char *name, char *out, size_t out_size)
+{
+    size_t name_len = strlen(name);
+    if (len <= name_len) return false;
+    for (size_t i = 0; i < name_len; i++)
+        if (tolower((unsigned char)line[i]) != tolower((unsigned char)name[i])) return false;
+    const char *v = line + name_len, *end = line + len;
+    while (v < end && (*v == ' ' || *v == '\t')) v++;
+    while (end > v && (end[-1] == '\r' || end[-1] == '\n' || end[-1] == ' ')) end--;
+    size_t n = (size_t)(end - v) < out_size - 1 ? (size_t)(end - v) : out_size - 1;
+    memcpy(out, v, n);
+    out[n] = '\0';
+    return true;
+}
+
+static size_t pull_header_callback(char *buffer, size_t size, size_t nitems, void *userdata)
 {
-    if (!curl || !url || !out) return false;
+    size_t len = size * nitems;
+    PullJob *job = (PullJob *)userdata;
+    if (len >= 5 && strncmp(buffer, "HTTP/", 5) == 0)
+    {
+        const char *code = memchr(buffer, ' ', len);
+        job->status = code ? strtol(code + 1, NULL, 10) : 0;
+        job->new_etag[0] = job->new_last_modified[0] = '\0'; /* every redirect hop starts over */
+    }
+    else if (!CopyHeaderValue(buffer, len, "ETag:", job->new_etag, sizeof(job->new_etag)))
+        CopyHeaderValue(buffer, len, "Last-Modified:", job->new_last_modified, sizeof(job->new_last_modified));
+    return len;
+}
 
-    struct MemoryStruct chunk;
-    chunk.memory = malloc(1);
-    chunk.size = 0;
+static CURL *CreatePullHandle(PullJob *job, long timeout_s)
+{
+    CURL *curl = curl_easy_init();
+    if (!curl) return NULL;
 
-    curl_easy_setopt(curl, CURLOPT_URL, url);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)&chunk);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_memory_callback);
+    curl_easy_setopt(curl, CURLOPT_URL, job->url);
+    curl_easy_setopt(curl, CURLOPT_PRIVATE, (char *)job);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)job);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, pull_write_callback);
     curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
     curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, ""); /* handle compression */
-    
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, timeout_s);
+    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, timeout_s < 10 ? timeout_s : 10L);
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L); /* timeouts from a background thread */
+    curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, pull_header_callback);
+    curl_easy_setopt(curl, CURLOPT_HEADERDATA, (void *)job);
+
+    char header[256]; /* not TextFormat, its buffers belong to the render thread */
+    if (job->etag[0])
+    {
+        snprintf(header, sizeof(header), "If-None-Match: %s", job->etag);
+        job->headers = curl_slist_append(job->headers, header);
+    }
+    if (job->last_modified[0])
+    {
+        snprintf(header, sizeof(header), "If-Modified-Since: %s", job->last_modified);
+        job->headers = curl_slist_append(job->headers, header);
+    }
+    if (job->headers)
+        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, job->headers);
+
     char user_agent[256];
     snprintf(user_agent, sizeof(user_agent), "Mozilla 5.0 (compatible; TLEscope/%s; +https://github.com/aweeri/TLEscope)", TLESCOPE_VERSION);
     curl_easy_setopt(curl, CURLOPT_USERAGENT, user_agent);
@@ -488,56 +666,179 @@ static bool DownloadTLESource(CURL *curl, const char *url, FILE *out)
 #if defined(_WIN32) || defined(_WIN64)
     curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
 #endif
+    return curl;
+}
 
-    CURLcode res = curl_easy_perform(curl);
-    long http_code = 0;
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
-
-    bool ok = (res == CURLE_OK && http_code == 200);
-    if (ok)
+static void FinishPullJob(PullJob *job, CURL *curl, CURLcode res)
+{
+    job->result = res;
+    if (curl)
     {
-        fwrite(chunk.memory, 1, chunk.size, out);
-        fprintf(out, "\r\n");
+        double total = 0.0;
+        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &job->http_code);
+        curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME, &total);
+        job->latency_ms = total * 1000.0;
+        curl_easy_cleanup(curl);
     }
+    curl_slist_free_all(job->headers);
+    job->headers = NULL;
+
+    job->ok = (res == CURLE_OK && job->http_code == 200);
+    if (job->ok && !OpenPullSpool(job)) job->ok = false; /* empty body, nothing opened the spool yet */
+    if (job->spool && fclose(job->spool) != 0) job->ok = false;
+    job->spool = NULL;
+
+    if (job->ok)
+        job->ok = SavePullCache(job);
+    else if (res == CURLE_OK && job->http_code == 304)
+        job->ok = job->not_modified = CopyPullCacheBody(job, NULL);
+
+    if (job->ok)
+        tle_stream_finish(job->stream);
     else
     {
-        printf("Failed to download %s: %s (HTTP %ld)\n", url, curl_easy_strerror(res), http_code);
+        char path[280];
+        PullSpoolPath(job, path, sizeof(path));
+        remove(path);
+        tle_stream_free(job->stream);
+        job->stream = NULL;
     }
+    if (!job->ok)
+        fprintf(stderr, "Failed to download %s: %s (HTTP %ld)\n", job->url, curl_easy_strerror(res), job->http_code);
+    job->done = true;
+    __sync_fetch_and_add(&pull_jobs_done, 1);
+}
 
-    free(chunk.memory);
-    return ok;
+/* runs every job on one curl multi handle, at most max_parallel transfers in flight. bodies are parsed as they arrive */
+static void RunPullJobs(PullJob *jobs, int count, int max_parallel, long timeout_s)
+{
+    CURLM *multi = curl_multi_init();
+    if (!multi)
+    {
+        for (int i = 0; i < count; i++)
+            FinishPullJob(&jobs[i], NULL, CURLE_FAILED_INIT);
+        return;
+    }
+
+    int next = 0, active = 0;
+    while (next < count || active > 0)
+    {
+        while (active < max_parallel && next < count)
+        {
+            PullJob *job = &jobs[next++];
+            CURL *curl = CreatePullHandle(job, timeout_s);
+            if (!curl || curl_multi_add_handle(multi, curl) != CURLM_OK)
+            {
+                if (curl) curl_easy_cleanup(curl);
+                FinishPullJob(job, NULL, CURLE_FAILED_INIT);
+                continue;
+            }
+            active++;
+        }
+
+        int running = 0;
+        curl_multi_perform(multi, &running);
+
+        CURLMsg *msg;
+        int left;
+        while ((msg = curl_multi_info_read(multi, &left)))
+        {
+            if (msg->msg != CURLMSG_DONE) continue;
+            CURL *curl = msg->easy_handle;
+            CURLcode res = msg->data.result;
+            char *priv = NULL;
+            curl_easy_getinfo(curl, CURLINFO_PRIVATE, &priv);
+            curl_multi_remove_handle(multi, curl);
+            FinishPullJob((PullJob *)priv, curl, res);
+            active--;
+        }
+
+        if (active > 0)
+            curl_multi_wait(multi, NULL, 0, 200, NULL);
+    }
+    curl_multi_cleanup(multi);
+}
+
+/* last pull's outcome for one source, right aligned in its TLE manager row */
+static void DrawPullStatus(int group, int index, Rectangle row, AppConfig *cfg, Font customFont)
+{
+    if (pull_state == PULL_BUSY) return;
+    for (int i = 0; i < pull_job_count; i++)
+    {
+        const PullJob *job = &pull_jobs[i];
+        if (job->group != group || job->index != index || !job->done) continue;
+
+        const char *text;
+        if (job->not_modified)
+            text = TextFormat("unchanged, %.0f ms", job->latency_ms);
+        else if (job->ok && job->bytes >= 1024 * 1024)
+            text = TextFormat("%.1f MB, %.0f ms", job->bytes / (1024.0 * 1024.0), job->latency_ms);
+        else if (job->ok)
+            text = TextFormat("%.0f kB, %.0f ms", job->bytes / 1024.0, job->latency_ms);
+        else if (job->result == CURLE_OPERATION_TIMEDOUT)
+            text = "timed out";
+        else if (job->http_code != 0)
+            text = TextFormat("failed, HTTP %ld", job->http_code);
+        else
+            text = "failed";
+
+        float size = 13 * cfg->ui_scale;
+        float w = MeasureTextEx(customFont, text, size, 1.0f).x;
+        DrawUIText(customFont, text, row.x + row.width - w - 8 * cfg->ui_scale, row.y + 6 * cfg->ui_scale, size, job->ok ? cfg->text_secondary : RED);
+        return;
+    }
 }
 
 static void ReloadTLEsLocally(UIContext *ctx, AppConfig *cfg)
 {
+    int selected_norad = (ctx && *ctx->selected_sat) ? norad_number((*ctx->selected_sat)->norad_id) : -1;
     if (ctx)
     {
         *ctx->selected_sat = NULL;
         ctx->hovered_sat = NULL;
         ctx->active_sat = NULL;
-        *ctx->active_lock = LOCK_EARTH;
     }
     locked_pass_sat = NULL;
+    CancelPassCalculation();
     num_passes = 0;
     last_pass_calc_sat = NULL;
-    sat_count = 0;
     load_tle_data("data.tle");
     load_manual_tles(cfg);
     LoadSatSelection();
+
+    /* the selection survives if its satellite is still around */
+    int slot = find_satellite_slot(selected_norad);
+    if (ctx && slot >= 0)
+        *ctx->selected_sat = last_selected_sat = &satellites[slot];
+    else if (ctx)
+        *ctx->active_lock = LOCK_EARTH;
 }
 
-/* background thread: downloads all selected TLE sources to data.tle */
-static void *PullTLEThread(void *arg)
+static void AddPullJob(int group, int index, const char *url)
 {
-    (void)arg;
-    AppConfig *cfg = pull_cfg;
+    if (pull_job_count >= MAX_PULL_JOBS) return;
+    PullJob *job = &pull_jobs[pull_job_count++];
+    memset(job, 0, sizeof(*job));
+    job->group = group;
+    job->index = index;
+    strncpy(job->url, url, sizeof(job->url) - 1);
+    LoadPullCacheMeta(job);
+}
 
-    FILE *out = fopen("data.tle", "wb");
-    if (!out)
+static void FreePullStreams(void)
+{
+    for (int i = 0; i < pull_job_count; i++)
     {
-        pull_state = PULL_ERROR;
-        return NULL;
+        tle_stream_free(pull_jobs[i].stream);
+        pull_jobs[i].stream = NULL;
     }
+}
+
+/* background thread: downloads and parses all selected TLE sources side by side, then writes data.tle in source order */
+static void *PullTLEThread(void *arg)
+{
+    (void)arg;
+    AppConfig *cfg = pull_cfg;
 
     unsigned int mask = 0, ret_mask = 0, cust_mask = 0;
     for (int i = 0; i < 25; i++)
@@ -547,35 +848,67 @@ static void *PullTLEThread(void *arg)
     for (int i = 0; i < cfg->custom_tle_source_count; i++)
         if (cfg->custom_tle_sources[i].selected) cust_mask |= (1 << i);
 
-    fprintf(out, "# EPOCH:%ld MASK:%u CUST_MASK:%u RET_MASK:%u\r\n", (long)time(NULL), mask, cust_mask, ret_mask);
+    FreePullStreams();
+    pull_job_count = 0;
+    for (int i = 0; i < NUM_RETLECTOR_SOURCES; i++)
+        if (ret_mask & (1 << i)) AddPullJob(PULL_GROUP_RETLECTOR, i, RETLECTOR_SOURCES[i].url);
+    for (int i = 0; i < 25; i++)
+        if (mask & (1 << i)) AddPullJob(PULL_GROUP_CELESTRAK, i, SOURCES[i].url);
+    for (int i = 0; i < cfg->custom_tle_source_count; i++)
+        if (cust_mask & (1 << i)) AddPullJob(PULL_GROUP_CUSTOM, i, cfg->custom_tle_sources[i].url);
+    pull_job_total = pull_job_count;
+
+    /* the satellites land in here as they're parsed. reserving it is only address space, memory gets committed as it fills */
+    pull_staging.catalog = alloc_catalog();
+    pull_staging.count = 0;
+    MakeDirectory(TLE_CACHE_DIR);
+    int max_parallel = cfg->pull_concurrency > 0 ? cfg->pull_concurrency : 1;
+    long timeout_s = cfg->pull_timeout_s > 0 ? cfg->pull_timeout_s : 30;
+    RunPullJobs(pull_jobs, pull_job_count, max_parallel, timeout_s);
 
     int ok_count = 0, fail_count = 0;
-    CURL *curl = curl_easy_init();
-    if (curl)
+    for (int i = 0; i < pull_job_count; i++)
     {
-        for (int i = 0; i < NUM_RETLECTOR_SOURCES; i++)
-            if (ret_mask & (1 << i))
-            { if (DownloadTLESource(curl, RETLECTOR_SOURCES[i].url, out)) ok_count++; else fail_count++; }
-
-        for (int i = 0; i < 25; i++)
-            if (mask & (1 << i))
-            { if (DownloadTLESource(curl, SOURCES[i].url, out)) ok_count++; else fail_count++; }
-
-        for (int i = 0; i < cfg->custom_tle_source_count; i++)
-            if (cust_mask & (1 << i))
-            { if (DownloadTLESource(curl, cfg->custom_tle_sources[i].url, out)) ok_count++; else fail_count++; }
+        if (pull_jobs[i].ok) ok_count++;
+        else fail_count++;
+    }
 
-        curl_easy_cleanup(curl);
+    /* nothing came through, keep the catalog we have. the bodies are already parsed, data.tle is only for the next launch */
+    FILE *out = (ok_count > 0 || pull_job_count == 0) ? fopen("data.tle", "wb") : NULL;
+    if (out)
+    {
+        fprintf(out, "# EPOCH:%ld MASK:%u CUST_MASK:%u RET_MASK:%u\r\n", (long)time(NULL), mask, cust_mask, ret_mask);
+        for (int i = 0; i < pull_job_count; i++)
+        {
+            if (!pull_jobs[i].ok) continue;
+            CopyPullCacheBody(&pull_jobs[i], out);
+            fprintf(out, "\r\n");
+        }
+        fclose(out);
+
+        /* the next catalog only gets put in source order here (failed sources dropped), the main thread just swaps it in */
+        TleStream *streams[MAX_PULL_JOBS];
+        int stream_count = 0;
+        for (int i = 0; i < pull_job_count; i++)
+            if (pull_jobs[i].ok) streams[stream_count++] = pull_jobs[i].stream;
+        if (pull_staging.catalog)
+        {
+            pull_catalog_count = finish_staged_catalog(&pull_staging, streams, stream_count, "data.tle");
+            pull_catalog = pull_staging.catalog;
+            pull_staging.catalog = NULL;
+        }
     }
-    else
+    free_catalog(pull_staging.catalog, pull_staging.count); /* nothing came through */
+    pull_staging.catalog = NULL;
+    if (!pull_catalog && (ok_count > 0 || pull_job_count == 0))
     {
-        printf("Failed to initialize libcurl.\n");
+        fail_count++;
+        ok_count = 0;
     }
 
-    fclose(out);
-
+    FreePullStreams();
     pull_partial = (ok_count > 0 && fail_count > 0);
-    __sync_synchronize(); /* ensure pull_partial is visible before pull_state on ARM */
+    __sync_synchronize(); /* ensure pull_partial, the job stats and pull_catalog are visible before pull_state on ARM */
     if (fail_count > 0 && ok_count == 0) pull_state = PULL_ERROR;
     else pull_state = PULL_DONE;
     return NULL;
@@ -588,10 +921,19 @@ static void PullTLEThreadWin(void *arg) { PullTLEThread(arg); }
 /* called from main thread to kick off async pull */
 static void PullTLEData(AppConfig *cfg)
 {
-    if (pull_state == PULL_BUSY) return;
+    if (pull_state == PULL_BUSY || pull_state == PULL_DONE) return; /* a finished pull waits for its swap */
     pull_state = PULL_BUSY;
     pull_partial = false;
     pull_cfg = cfg;
+    pull_jobs_done = 0;
+    pull_job_total = 0;
+
+    static bool curl_ready = false;
+    if (!curl_ready)
+    {
+        curl_global_init(CURL_GLOBAL_DEFAULT); /* curl_multi_init() won't do it for us, and it's not thread safe */
+        curl_ready = true;
+    }
 
 #if defined(_WIN32) || defined(_WIN64)
     uintptr_t h = _beginthread(PullTLEThreadWin, 0, NULL);
@@ -604,33 +946,33 @@ static void PullTLEData(AppConfig *cfg)
 #endif
 }
 
-/* called each frame from DrawGUI to finish reload on the main thread */
+/* called each frame from DrawGUI: publishes the catalog the pull thread built, between two frames. what was selected,
+   active or cached stays that way for every satellite that's still in there */
 static void FinishPullIfDone(UIContext *ctx, AppConfig *cfg)
 {
-    if (pull_state == PULL_DONE)
-    {
-        if (ctx)
-        {
-            *ctx->selected_sat = NULL;
-            ctx->hovered_sat = NULL;
-            ctx->active_sat = NULL;
-            *ctx->active_lock = LOCK_EARTH;
-        }
-        locked_pass_sat = NULL;
-        num_passes = 0;
-        last_pass_calc_sat = NULL;
-        sat_count = 0;
-        load_tle_data("data.tle");
-        load_manual_tles(cfg);
-        if (sat_count > 500)
-        {
-            for (int i = 0; i < sat_count; i++)
-                satellites[i].is_active = false;
-        }
+    if (pull_state != PULL_DONE) return;
+
+    bool first_catalog = (sat_count == 0);
+    int count = append_manual_tles(pull_catalog, pull_catalog_count, cfg);
+    Satellite *no_sat = NULL;
+    Satellite **refs[] = {
+        ctx ? ctx->selected_sat : &no_sat,
+        ctx ? &ctx->hovered_sat : &no_sat,
+        ctx ? &ctx->active_sat : &no_sat,
+        &locked_pass_sat,
+        &last_selected_sat,
+    };
+    bool had_selection = ctx && *ctx->selected_sat;
+    swap_catalog(pull_catalog, count, count <= 500, refs, sizeof(refs) / sizeof(refs[0]), &selected_pass_idx);
+    pull_catalog = NULL;
+    pull_catalog_count = 0;
+
+    if (had_selection && !*ctx->selected_sat)
+        *ctx->active_lock = LOCK_EARTH;
+    if (first_catalog)
         LoadSatSelection();
-        data_tle_epoch = time(NULL);
-        pull_state = PULL_IDLE;
-    }
+    data_tle_epoch = time(NULL);
+    pull_state = PULL_IDLE;
 }
 
 static void CalculateLunarPass(double base_epoch, double *aos, double *los, Vector2 *pts, int *num_pts)
@@ -901,7 +1243,7 @@ static bool IsAnyEditModeActive(void)
         &edit_hour, &edit_min, &edit_sec,
         &edit_unix,
         &edit_doppler_freq, &edit_doppler_res, &edit_doppler_file,
-        &edit_sat_search, &edit_min_el,
+        &edit_sat_search, &edit_min_el, &edit_pass_days,
         &edit_hl_name, &edit_hl_lat, &edit_hl_lon, &edit_hl_alt,
         &edit_fps, &edit_new_tle,
         &edit_scope_az, &edit_scope_el, &edit_scope_beam,
@@ -1023,26 +1365,93 @@ bool IsMouseOverUI(AppConfig *cfg)
     return false;
 }
 
+/* persistence.bin: which satellites are active, as a sorted list of catalog numbers. names aren't unique and get
+   cut at 24 characters, the numbers are neither */
+#define SELECTION_MAGIC "TLESSEL"
+#define SELECTION_VERSION 1
+
+typedef struct
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t count; // uint32_t catalog numbers follow, ascending
+} SelectionHeader;
+
+static int CompareCatalogNumbers(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
 void SaveSatSelection(void)
 {
-    FILE *f = fopen("persistence.bin", "wb");
-    if (!f)
+    uint32_t *ids = (uint32_t *)malloc(sizeof(uint32_t) * (sat_count > 0 ? sat_count : 1));
+    if (!ids)
         return;
-    int count = 0;
+    uint32_t count = 0;
     for (int i = 0; i < sat_count; i++)
-        if (satellites[i].is_active)
-            count++;
-    fwrite(&count, sizeof(int), 1, f);
+    {
+        int norad = norad_number(satellites[i].norad_id);
+        if (sat_hot[i].is_active && norad >= 0)
+            ids[count++] = (uint32_t)norad;
+    }
+    qsort(ids, count, sizeof(uint32_t), CompareCatalogNumbers);
+
+    SelectionHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SELECTION_MAGIC, sizeof(SELECTION_MAGIC));
+    header.version = SELECTION_VERSION;
+    header.count = count;
+
+    /* temp file and rename, a crash halfway through keeps the old selection */
+    FILE *f = fopen("persistence.bin.tmp", "wb");
+    bool written = f && fwrite(&header, sizeof(header), 1, f) == 1 && fwrite(ids, sizeof(uint32_t), count, f) == count;
+    if (f && fclose(f) != 0)
+        written = false;
+    free(ids);
+    if (!written || !replace_file("persistence.bin.tmp", "persistence.bin"))
+    {
+        fprintf(stderr, "Failed to save the satellite selection\n");
+        remove("persistence.bin.tmp");
+    }
+}
+
+static int CompareSatNames(const void *a, const void *b)
+{
+    return strcmp(satellites[*(const int *)a].name, satellites[*(const int *)b].name);
+}
+
+/* the old format: an int count, then length prefixed names. only read to carry a selection over, the next save replaces it */
+static void LoadLegacySatSelection(FILE *f, int count)
+{
+    int *by_name = (int *)malloc(sizeof(int) * (sat_count > 0 ? sat_count : 1));
+    if (!by_name)
+        return;
     for (int i = 0; i < sat_count; i++)
+        by_name[i] = i;
+    qsort(by_name, sat_count, sizeof(int), CompareSatNames);
+
+    for (int i = 0; i < count; i++)
     {
-        if (satellites[i].is_active)
+        unsigned char len;
+        char name[256] = {0};
+        if (fread(&len, 1, 1, f) != 1 || fread(name, 1, len, f) != len)
+            break;
+        int lo = 0, hi = sat_count - 1;
+        while (lo <= hi)
         {
-            unsigned char len = (unsigned char)strlen(satellites[i].name);
-            fwrite(&len, 1, 1, f);
-            fwrite(satellites[i].name, 1, len, f);
+            int mid = (lo + hi) / 2;
+            int cmp = strcmp(name, satellites[by_name[mid]].name);
+            if (cmp == 0)
+            {
+                sat_hot[by_name[mid]].is_active = true;
+                break;
+            }
+            if (cmp < 0) hi = mid - 1;
+            else lo = mid + 1;
         }
     }
-    fclose(f);
+    free(by_name);
 }
 
 void LoadSatSelection(void)
@@ -1050,31 +1459,39 @@ void LoadSatSelection(void)
     FILE *f = fopen("persistence.bin", "rb");
     if (!f)
         return;
-    int count;
-    if (fread(&count, sizeof(int), 1, f) != 1)
+    SelectionHeader header;
+    size_t got = fread(&header, 1, sizeof(header), f);
+    if (got < sizeof(header) || memcmp(header.magic, SELECTION_MAGIC, sizeof(header.magic)) != 0)
+    {
+        int legacy_count = 0;
+        if (got >= sizeof(int))
+            memcpy(&legacy_count, &header, sizeof(int));
+        if (got >= sizeof(int) && legacy_count >= 0)
+        {
+            for (int i = 0; i < sat_count; i++)
+                sat_hot[i].is_active = false;
+            fseek(f, sizeof(int), SEEK_SET);
+            LoadLegacySatSelection(f, legacy_count);
+        }
+        fclose(f);
+        return;
+    }
+    if (header.version != SELECTION_VERSION)
     {
         fclose(f);
         return;
     }
 
     for (int i = 0; i < sat_count; i++)
-        satellites[i].is_active = false;
-
-    for (int i = 0; i < count; i++)
+        sat_hot[i].is_active = false;
+    for (uint32_t i = 0; i < header.count; i++)
     {
-        unsigned char len;
-        char name[64] = {0};
-        if (fread(&len, 1, 1, f) != 1)
+        uint32_t norad;
+        if (fread(&norad, sizeof(norad), 1, f) != 1)
             break;
-        fread(name, 1, len, f);
-        for (int j = 0; j < sat_count; j++)
-        {
-            if (strcmp(satellites[j].name, name) == 0)
-            {
-                satellites[j].is_active = true;
-                break;
-            }
-        }
+        int slot = find_satellite_slot((int)norad);
+        if (slot >= 0)
+            sat_hot[slot].is_active = true;
     }
     fclose(f);
 }
@@ -1583,7 +2000,7 @@ void DrawGUI(UIContext *ctx, AppConfig *cfg, Font customFont)
         
         edit_year = edit_month = edit_day = edit_hour = edit_min = edit_sec = edit_unix = false;
         edit_doppler_freq = edit_doppler_res = edit_doppler_file = false;
-        edit_min_el = false;
+        edit_min_el = edit_pass_days = false;
         edit_hl_name = edit_hl_lat = edit_hl_lon = edit_hl_alt = false;
         edit_fps = false;
         edit_scope_az = edit_scope_el = edit_scope_beam = false;
@@ -1597,7 +2014,7 @@ void DrawGUI(UIContext *ctx, AppConfig *cfg, Font customFont)
         {
             edit_year = edit_month = edit_day = edit_hour = edit_min = edit_sec = edit_unix = false;
             edit_doppler_freq = edit_doppler_res = edit_doppler_file = false;
-            edit_sat_search = edit_min_el = false;
+            edit_sat_search = edit_min_el = edit_pass_days = false;
             edit_hl_name = edit_hl_lat = edit_hl_lon = edit_hl_alt = false;
             edit_fps = false;
             edit_scope_az = edit_scope_el = edit_scope_beam = false;
@@ -1758,17 +2175,22 @@ void DrawGUI(UIContext *ctx, AppConfig *cfg, Font customFont)
         RotatorEndDrag();
     }
 
+    /* swap in background pass results as soon as they land */
+    PollPassCalculation();
+
     if (show_passes_dialog)
     {
         if (multi_pass_mode)
         {
-            if (last_pass_calc_sat != NULL || (num_passes > 0 && *ctx->current_epoch > passes[0].los_epoch + 1.0 / 1440.0))
+            if (!IsPassCalculationRunning() && (last_pass_calc_sat != NULL || (num_passes > 0 && *ctx->current_epoch > passes[0].los_epoch + 1.0 / 1440.0)))
             {
-                CalculatePasses(NULL, *ctx->current_epoch);
+                StartPassCalculation(*ctx->current_epoch);
             }
         }
         else
         {
+            /* an all-satellite search finishing now would clobber the targeted list */
+            CancelPassCalculation();
             if (*ctx->selected_sat == NULL)
             {
                 num_passes = 0;
@@ -1867,7 +2289,7 @@ void DrawGUI(UIContext *ctx, AppConfig *cfg, Font customFont)
 
     /* render context-sensitive apsis text markers */
     bool hide_apsis_text = (*ctx->is_pov_mode && *ctx->selected_sat != NULL && ctx->active_sat == *ctx->selected_sat);
-    if (ctx->active_sat && ctx->active_sat->is_active && !hide_apsis_text)
+    if (ctx->active_sat && satellite_hot(ctx->active_sat)->is_active && !hide_apsis_text)
     {
         Vector2 periScreen, apoScreen;
         bool show_peri = true, show_apo = true;
@@ -2153,7 +2575,7 @@ void DrawGUI(UIContext *ctx, AppConfig *cfg, Font customFont)
         {
             FindSmartWindowPosition(357 * cfg->ui_scale, 380 * cfg->ui_scale, cfg, &pd_x, &pd_y);
             if (multi_pass_mode)
-                CalculatePasses(NULL, *ctx->current_epoch);
+                StartPassCalculation(*ctx->current_epoch);
             else if (*ctx->selected_sat)
                 CalculatePasses(*ctx->selected_sat, *ctx->current_epoch);
             else
@@ -2316,7 +2738,7 @@ void DrawGUI(UIContext *ctx, AppConfig *cfg, Font customFont)
 
             {
                 const char *btn_label = "Apply";
-                if (pull_state == PULL_BUSY) btn_label = "Pulling..";
+                if (pull_state == PULL_BUSY) btn_label = pull_job_total > 0 ? TextFormat("Pulling %d/%d", pull_jobs_done, pull_job_total) : "Pulling..";
                 else if (pull_state == PULL_ERROR) btn_label = "Error";
                 else if (pull_partial) btn_label = "Partial";
                 if (pull_state == PULL_BUSY) GuiDisable();
@@ -2378,6 +2800,7 @@ void DrawGUI(UIContext *ctx, AppConfig *cfg, Font customFont)
                             (Rectangle){viewRec.x + 10 * cfg->ui_scale + tle_mgr_scroll.x, current_y + 4 * cfg->ui_scale, 16 * cfg->ui_scale, 16 * cfg->ui_scale}, RETLECTOR_SOURCES[i].name,
                             &retlector_selected[i]
                         );
+                        DrawPullStatus(PULL_GROUP_RETLECTOR, i, (Rectangle){viewRec.x + tle_mgr_scroll.x, current_y, viewRec.width, 25 * cfg->ui_scale}, cfg, customFont);
                     }
                     current_y += 25 * cfg->ui_scale;
                 }
@@ -2406,6 +2829,7 @@ void DrawGUI(UIContext *ctx, AppConfig *cfg, Font customFont)
                         GuiCheckBox(
                             (Rectangle){viewRec.x + 10 * cfg->ui_scale + tle_mgr_scroll.x, current_y + 4 * cfg->ui_scale, 16 * cfg->ui_scale, 16 * cfg->ui_scale}, SOURCES[i].name, &celestrak_selected[i]
                         );
+                        DrawPullStatus(PULL_GROUP_CELESTRAK, i, (Rectangle){viewRec.x + tle_mgr_scroll.x, current_y, viewRec.width, 25 * cfg->ui_scale}, cfg, customFont);
                     }
                     current_y += 25 * cfg->ui_scale;
                 }
@@ -2435,6 +2859,7 @@ void DrawGUI(UIContext *ctx, AppConfig *cfg, Font customFont)
                             (Rectangle){viewRec.x + 10 * cfg->ui_scale + tle_mgr_scroll.x, current_y + 4 * cfg->ui_scale, 16 * cfg->ui_scale, 16 * cfg->ui_scale}, cfg->custom_tle_sources[i].name,
                             &cfg->custom_tle_sources[i].selected
                         );
+                        DrawPullStatus(PULL_GROUP_CUSTOM, i, (Rectangle){viewRec.x + tle_mgr_scroll.x, current_y, viewRec.width, 25 * cfg->ui_scale}, cfg, customFont);
                     }
                     current_y += 25 * cfg->ui_scale;
                 }
@@ -2540,8 +2965,8 @@ void DrawGUI(UIContext *ctx, AppConfig *cfg, Font customFont)
             bool doCheckAll = GuiButton((Rectangle){sm_x + smWindow.width - 75 * cfg->ui_scale, sm_y + 35 * cfg->ui_scale, 30 * cfg->ui_scale, 24 * cfg->ui_scale}, "#80#");
             bool doUncheckAll = GuiButton((Rectangle){sm_x + smWindow.width - 40 * cfg->ui_scale, sm_y + 35 * cfg->ui_scale, 30 * cfg->ui_scale, 24 * cfg->ui_scale}, "#79#");
 
-            int filtered_indices[MAX_SATELLITES], filtered_count = 0;
-            for (int i = 0; i < sat_count; i++)
+            int *filtered_indices = FrameAlloc(sizeof(int) * (sat_count > 0 ? sat_count : 1)), filtered_count = 0;
+            for (int i = 0; i < sat_count && filtered_indices; i++)
             {
                 if (string_contains_ignore_case(satellites[i].name, sat_search_text) || 
                     string_contains_ignore_case(satellites[i].norad_id, sat_search_text) || 
@@ -2550,9 +2975,9 @@ void DrawGUI(UIContext *ctx, AppConfig *cfg, Font customFont)
                 {
                     filtered_indices[filtered_count++] = i;
                     if (doCheckAll)
-                        satellites[i].is_active = true;
+                        sat_hot[i].is_active = true;
                     if (doUncheckAll)
-                        satellites[i].is_active = false;
+                        sat_hot[i].is_active = false;
                 }
             }
 
@@ -2562,7 +2987,7 @@ void DrawGUI(UIContext *ctx, AppConfig *cfg, Font customFont)
                 if (show_passes_dialog)
                 {
                     if (multi_pass_mode)
-                        CalculatePasses(NULL, *ctx->current_epoch);
+                        StartPassCalculation(*ctx->current_epoch);
                     else if (*ctx->selected_sat)
                         CalculatePasses(*ctx->selected_sat, *ctx->current_epoch);
                 }
@@ -2600,16 +3025,16 @@ void DrawGUI(UIContext *ctx, AppConfig *cfg, Font customFont)
                     Rectangle cbRec = {viewRec.x + 4 * cfg->ui_scale + sat_mgr_scroll.x, item_y + 4 * cfg->ui_scale, 16 * cfg->ui_scale, 16 * cfg->ui_scale};
                     Rectangle textRec = {viewRec.x + 24 * cfg->ui_scale + sat_mgr_scroll.x, item_y, viewRec.width - 28 * cfg->ui_scale, 25 * cfg->ui_scale};
 
-                    bool was_active = satellites[sat_idx].is_active;
-                    GuiCheckBox(cbRec, "", &satellites[sat_idx].is_active);
+                    bool was_active = sat_hot[sat_idx].is_active;
+                    GuiCheckBox(cbRec, "", &sat_hot[sat_idx].is_active);
 
-                    if (was_active != satellites[sat_idx].is_active)
+                    if (was_active != sat_hot[sat_idx].is_active)
                     {
                         SaveSatSelection();
                         if (show_passes_dialog)
                         {
                             if (multi_pass_mode)
-                                CalculatePasses(NULL, *ctx->current_epoch);
+                                StartPassCalculation(*ctx->current_epoch);
                             else if (*ctx->selected_sat)
                                 CalculatePasses(*ctx->selected_sat, *ctx->current_epoch);
                         }
@@ -2853,7 +3278,7 @@ void DrawGUI(UIContext *ctx, AppConfig *cfg, Font customFont)
                 if (show_passes_dialog)
                 {
                     if (multi_pass_mode)
-                        CalculatePasses(NULL, *ctx->current_epoch);
+                        StartPassCalculation(*ctx->current_epoch);
                     else if (*ctx->selected_sat)
                         CalculatePasses(*ctx->selected_sat, *ctx->current_epoch);
                 }
@@ -3014,13 +3439,14 @@ void DrawGUI(UIContext *ctx, AppConfig *cfg, Font customFont)
                 show_passes_dialog = false;
 
             if (GuiButton(
-                    (Rectangle){passesWindow.x + 20 * cfg->ui_scale, passesWindow.y + 30 * cfg->ui_scale, passesWindow.width - 160 * cfg->ui_scale, 24 * cfg->ui_scale},
+                    (Rectangle){passesWindow.x + 20 * cfg->ui_scale, passesWindow.y + 30 * cfg->ui_scale, passesWindow.width - 250 * cfg->ui_scale, 24 * cfg->ui_scale},
                     multi_pass_mode ? "Mode: All Passes" : "Mode: Targeted only"
                 ))
             {
                 multi_pass_mode = !multi_pass_mode;
+                text_pass_days[0] = '\0';
                 if (multi_pass_mode)
-                    CalculatePasses(NULL, *ctx->current_epoch);
+                    StartPassCalculation(*ctx->current_epoch);
                 else if (*ctx->selected_sat)
                     CalculatePasses(*ctx->selected_sat, *ctx->current_epoch);
                 else
@@ -3035,9 +3461,47 @@ void DrawGUI(UIContext *ctx, AppConfig *cfg, Font customFont)
                 (Rectangle){passesWindow.x + passesWindow.width - 55 * cfg->ui_scale, passesWindow.y + 30 * cfg->ui_scale, 45 * cfg->ui_scale, 24 * cfg->ui_scale}, text_min_el, 8, &edit_min_el, true
             );
 
+            /* search window in days, for whichever mode is showing. applied once the box loses focus */
+            static bool was_editing_days = false;
+            float *days_setting = multi_pass_mode ? &cfg->pass_days_all : &cfg->pass_days_targeted;
+            if (!edit_pass_days && text_pass_days[0] == '\0')
+                snprintf(text_pass_days, sizeof(text_pass_days), "%g", *days_setting);
+            GuiLabel((Rectangle){passesWindow.x + passesWindow.width - 222 * cfg->ui_scale, passesWindow.y + 30 * cfg->ui_scale, 40 * cfg->ui_scale, 24 * cfg->ui_scale}, "Days:");
+            AdvancedTextBox(
+                (Rectangle){passesWindow.x + passesWindow.width - 180 * cfg->ui_scale, passesWindow.y + 30 * cfg->ui_scale, 40 * cfg->ui_scale, 24 * cfg->ui_scale}, text_pass_days, 8, &edit_pass_days, true
+            );
+            if (was_editing_days && !edit_pass_days)
+            {
+                float days = atof(text_pass_days);
+                if (days < 0.1f) days = 0.1f;
+                if (days > 30.0f) days = 30.0f;
+                text_pass_days[0] = '\0';
+                if (days != *days_setting)
+                {
+                    *days_setting = days;
+                    pass_search_days = cfg->pass_days_all;
+                    pass_search_days_targeted = cfg->pass_days_targeted;
+                    SaveAppConfig("settings.json", cfg);
+                    if (multi_pass_mode)
+                        StartPassCalculation(*ctx->current_epoch);
+                    else if (*ctx->selected_sat)
+                        CalculatePasses(*ctx->selected_sat, *ctx->current_epoch);
+                }
+            }
+            was_editing_days = edit_pass_days;
+
             float min_el_threshold = atof(text_min_el);
-            int valid_passes[MAX_PASSES], valid_count = 0;
-            for (int i = 0; i < num_passes; i++)
+            if (num_passes > valid_passes_cap)
+            {
+                int *grown = (int *)realloc(valid_passes, sizeof(int) * num_passes);
+                if (grown)
+                {
+                    valid_passes = grown;
+                    valid_passes_cap = num_passes;
+                }
+            }
+            int valid_count = 0;
+            for (int i = 0; i < num_passes && i < valid_passes_cap; i++)
                 if (passes[i].max_el >= min_el_threshold)
                     valid_passes[valid_count++] = i;
 
@@ -3068,6 +3532,20 @@ void DrawGUI(UIContext *ctx, AppConfig *cfg, Font customFont)
                     cfg->text_main
                 );
             }
+            else if (multi_pass_mode && IsPassCalculationRunning())
+            {
+                char calc_str[64];
+                snprintf(calc_str, sizeof(calc_str), "Calculating passes... %d%%", (int)(GetPassCalculationProgress() * 100.0f));
+                DrawUIText(
+                    customFont, calc_str, viewRec.x + 10 * cfg->ui_scale + passes_scroll.x, viewRec.y + 10 * cfg->ui_scale + passes_scroll.y, 16 * cfg->ui_scale,
+                    cfg->text_main
+                );
+                Rectangle pb_bg = {viewRec.x + 10 * cfg->ui_scale, viewRec.y + 34 * cfg->ui_scale, viewRec.width - 20 * cfg->ui_scale, 4 * cfg->ui_scale};
+                DrawRectangleRec(pb_bg, cfg->ui_secondary);
+                DrawRectangleRec((Rectangle){pb_bg.x, pb_bg.y, pb_bg.width * GetPassCalculationProgress(), pb_bg.height}, cfg->ui_accent);
+                if (GuiButton((Rectangle){viewRec.x + 10 * cfg->ui_scale, viewRec.y + 46 * cfg->ui_scale, 80 * cfg->ui_scale, 24 * cfg->ui_scale}, "Cancel"))
+                    CancelPassCalculation();
+            }
             else if (valid_count == 0)
             {
                 DrawUIText(
@@ -3178,8 +3656,8 @@ void DrawGUI(UIContext *ctx, AppConfig *cfg, Font customFont)
                 DrawUIText(customFont, "S", cx - 5 * cfg->ui_scale, cy + r_max + 5 * cfg->ui_scale, 16 * cfg->ui_scale, cfg->text_secondary);
                 DrawUIText(customFont, "W", cx - r_max - 20 * cfg->ui_scale, cy - 8 * cfg->ui_scale, 16 * cfg->ui_scale, cfg->text_secondary);
 
+                const Vector2 *path_pts = polar_lunar_mode ? lunar_path_pts : GetPassPath(&passes[selected_pass_idx]);
                 int num_pts = polar_lunar_mode ? lunar_num_pts : passes[selected_pass_idx].num_pts;
-                Vector2 *path_pts = polar_lunar_mode ? lunar_path_pts : passes[selected_pass_idx].path_pts;
                 double p_aos = polar_lunar_mode ? lunar_aos : passes[selected_pass_idx].aos_epoch;
                 double p_los = polar_lunar_mode ? lunar_los : passes[selected_pass_idx].los_epoch;
                 Satellite *p_sat = polar_lunar_mode ? NULL : passes[selected_pass_idx].sat;
@@ -3490,7 +3968,8 @@ case WND_SCOPE:
             /* auto-aim scope if locked to a satellite */
             if (scope_lock && *ctx->selected_sat) {
                 double l_az, l_el;
-                Vector3 sat_pos = (*ctx->selected_sat)->is_active ? (*ctx->selected_sat)->current_pos : calculate_position(*ctx->selected_sat, get_unix_from_epoch(*ctx->current_epoch));
+                SatHot *hot = satellite_hot(*ctx->selected_sat);
+                Vector3 sat_pos = hot->is_active ? hot->current_pos : calculate_position(*ctx->selected_sat, get_unix_from_epoch(*ctx->current_epoch));
                 get_az_el(sat_pos, ctx->gmst_deg, home_location.lat, home_location.lon, home_location.alt, &l_az, &l_el);
                 scope_az = (float)l_az;
                 scope_el = (float)l_el;
@@ -3589,7 +4068,7 @@ case WND_SCOPE:
             DrawCircleLines(center.x, center.y, scope_radius, cfg->ui_secondary);
 
             /* draw orbit path arch for currently targeted satellite */
-            if (*ctx->selected_sat && (*ctx->selected_sat)->is_active) {
+            if (*ctx->selected_sat && satellite_hot(*ctx->selected_sat)->is_active) {
                 draw_satellite_orbit_arch(*ctx->selected_sat, *ctx->current_epoch, ctx->gmst_deg, 
                                         home_location, center, scope_radius, scope_az, scope_el, 
                                         scope_beam, cfg->orbit_highlighted);
@@ -3644,7 +4123,7 @@ case WND_SCOPE:
                 if (is_heo && !scope_show_heo) continue;
                 if (is_geo && !scope_show_geo) continue;
 
-                Vector3 sat_pos = satellites[i].is_active ? satellites[i].current_pos : calculate_position(&satellites[i], current_unix);
+                Vector3 sat_pos = sat_hot[i].is_active ? sat_hot[i].current_pos : calculate_position(&satellites[i], current_unix);
 
                 Vector3 V = Vector3Subtract(sat_pos, O_eci);
                 float dist = Vector3Length(V);
@@ -3679,9 +4158,9 @@ case WND_SCOPE:
                     if (cfg->highlight_sunlit) {
                         bool eclipsed = is_sat_eclipsed(sat_pos, sun_dir);
                         dotColor = eclipsed ? GRAY : GOLD;
-                        if (!satellites[i].is_active) dotColor = ApplyAlpha(dotColor, 0.65f);
+                        if (!sat_hot[i].is_active) dotColor = ApplyAlpha(dotColor, 0.65f);
                     } else {
-                        dotColor = satellites[i].is_active ? cfg->ui_accent : ApplyAlpha(cfg->text_secondary, 0.9f);
+                        dotColor = sat_hot[i].is_active ? cfg->ui_accent : ApplyAlpha(cfg->text_secondary, 0.9f);
                     }
 
                     if (*ctx->selected_sat == &satellites[i]) {
@@ -3771,10 +4250,10 @@ case WND_SCOPE:
 
             // visibility toggle for quick additions to satellite manager
             if (!*ctx->selected_sat) GuiDisable();
-            bool is_vis = *ctx->selected_sat && (*ctx->selected_sat)->is_active;
+            bool is_vis = *ctx->selected_sat && satellite_hot(*ctx->selected_sat)->is_active;
             if (GuiButton((Rectangle){sc_x + scopeWindow.width - 39 * cfg->ui_scale, ctrl_y, 24 * cfg->ui_scale, 24 * cfg->ui_scale}, is_vis ? "#44#" : "#45#")) {
                 if (*ctx->selected_sat) {
-                    (*ctx->selected_sat)->is_active = !(*ctx->selected_sat)->is_active;
+                    satellite_hot(*ctx->selected_sat)->is_active = !is_vis;
                     SaveSatSelection();
                 }
             }
@@ -3853,19 +4332,20 @@ case WND_SCOPE:
             if (*ctx->selected_sat)
             {
                 Satellite *sat = *ctx->selected_sat;
-                double r_km = Vector3Length(sat->current_pos);
+                Vector3 sat_pos = satellite_hot(sat)->current_pos;
+                double r_km = Vector3Length(sat_pos);
                 double v_kms = sqrt(MU * (2.0 / r_km - 1.0 / sat->semi_major_axis));
-                float lat_deg = asinf(sat->current_pos.y / r_km) * RAD2DEG;
-                float lon_deg = (atan2f(-sat->current_pos.z, sat->current_pos.x) - ((ctx->gmst_deg + cfg->earth_rotation_offset) * DEG2RAD)) * RAD2DEG;
+                float lat_deg = asinf(sat_pos.y / r_km) * RAD2DEG;
+                float lon_deg = (atan2f(-sat_pos.z, sat_pos.x) - ((ctx->gmst_deg + cfg->earth_rotation_offset) * DEG2RAD)) * RAD2DEG;
                 while (lon_deg > 180.0f) lon_deg -= 360.0f;
                 while (lon_deg < -180.0f) lon_deg += 360.0f;
 
                 Vector3 sun_pos = calculate_sun_position(*ctx->current_epoch);
                 Vector3 sun_dir = Vector3Normalize(sun_pos);
-                bool eclipsed = is_sat_eclipsed(sat->current_pos, sun_dir);
+                bool eclipsed = is_sat_eclipsed(sat_pos, sun_dir);
 
                 double c_az, c_el;
-                get_az_el(sat->current_pos, ctx->gmst_deg, home_location.lat, home_location.lon, home_location.alt, &c_az, &c_el);
+                get_az_el(sat_pos, ctx->gmst_deg, home_location.lat, home_location.lon, home_location.alt, &c_az, &c_el);
                 double s_range = get_sat_range(sat, *ctx->current_epoch, home_location);
 
                 double t_peri_unix, t_apo_unix;
@@ -4218,7 +4698,7 @@ case WND_SCOPE:
         int cached_count = 0;
         for (int i = 0; i < sat_count; i++)
         {
-            if (satellites[i].is_active)
+            if (sat_hot[i].is_active)
             {
                 active_render_count++;
                 if (satellites[i].orbit_cached)
@@ -4226,35 +4706,32 @@ case WND_SCOPE:
             }
         }
 
-        int global_orbit_step = 1;
-        if (active_render_count > 10000)
-            global_orbit_step = 100;
-        else if (active_render_count > 5000)
-            global_orbit_step = 18;
-        else if (active_render_count > 2000)
-            global_orbit_step = 8;
-        else if (active_render_count > 500)
-            global_orbit_step = 4;
-        else if (active_render_count > 200)
-            global_orbit_step = 2;
-
         float stats_x = 10 * cfg->ui_scale;
 
         // UI Statistics
         DrawUIText(customFont, TextFormat("%3i FPS", GetFPS()), stats_x, 10 * cfg->ui_scale, 20 * cfg->ui_scale, cfg->ui_accent);
         DrawUIText(customFont, TextFormat("%i Sats (%i active)", sat_count, active_render_count), stats_x, 34 * cfg->ui_scale, 16 * cfg->ui_scale, cfg->text_secondary);
-        DrawUIText(customFont, TextFormat("Orbit Step: %i", global_orbit_step), stats_x, 52 * cfg->ui_scale, 16 * cfg->ui_scale, cfg->text_secondary);
+        OrbitLinesStats orbit_stats = OrbitLinesGetStats();
+        DrawUIText(customFont, TextFormat("Orbit VBO: %i/%i drawn, %.1f MB, %.2fM seg", orbit_stats.drawn, orbit_stats.resident, orbit_stats.bytes / (1024.0f * 1024.0f), orbit_stats.instances / 1e6f), stats_x, 52 * cfg->ui_scale, 16 * cfg->ui_scale, cfg->text_secondary);
         DrawUIText(customFont, TextFormat("Cache: %i/%i", cached_count, active_render_count), stats_x, 70 * cfg->ui_scale, 16 * cfg->ui_scale, cfg->text_secondary);
 
-        size_t sat_mem = sat_count * sizeof(Satellite);
-        DrawUIText(customFont, TextFormat("Mem: %.2f MB", sat_mem / (1024.0f * 1024.0f)), stats_x, 88 * cfg->ui_scale, 16 * cfg->ui_scale, cfg->text_secondary);
+        size_t sat_mem = catalog_memory_bytes() + sat_batch_memory_bytes(); // committed catalog, caches, batch buffers
+        DrawUIText(customFont, TextFormat("Mem: %.2f MB committed", sat_mem / (1024.0f * 1024.0f)), stats_x, 88 * cfg->ui_scale, 16 * cfg->ui_scale, cfg->text_secondary);
 
         int prop_per_sec = GetFPS() * 50; // based on the 50-sat async step in main.c
-        DrawUIText(customFont, TextFormat("Prop Rate: %i/s", prop_per_sec), stats_x, 106 * cfg->ui_scale, 14 * cfg->ui_scale, cfg->text_secondary);
+        DrawUIText(customFont, TextFormat("Prop Rate: %i/s (%s)", prop_per_sec, propagator_kernel_name()), stats_x, 106 * cfg->ui_scale, 14 * cfg->ui_scale, cfg->text_secondary);
 
         Vector3 sun_pos = calculate_sun_position(*ctx->current_epoch);
         DrawUIText(customFont, TextFormat("GMST: %.4f deg", ctx->gmst_deg), stats_x, 128 * cfg->ui_scale, 14 * cfg->ui_scale, cfg->ui_accent);
         DrawUIText(customFont, TextFormat("Sun ECI: %.3f, %.3f, %.3f", sun_pos.x, sun_pos.y, sun_pos.z), stats_x, 144 * cfg->ui_scale, 14 * cfg->ui_scale, cfg->ui_accent);
+
+        PassSearchStats pass_stats = GetPassSearchStats();
+        DrawUIText(customFont, TextFormat("Pass Filter: %i/%i skipped, %i cached", pass_stats.skipped, pass_stats.candidates, pass_stats.cached), stats_x, 160 * cfg->ui_scale, 14 * cfg->ui_scale, cfg->text_secondary);
+        DrawUIText(customFont, TextFormat("Pass Search: %lld SGP4 (%s, %.0f ms)", pass_stats.scan_calls, pass_stats.adaptive ? "adaptive" : "fixed", pass_stats.elapsed_ms), stats_x, 176 * cfg->ui_scale, 14 * cfg->ui_scale, cfg->text_secondary);
+
+        /* the overlay draws late, so used is nearly the whole frame; peak is the high-water mark since startup */
+        FrameArenaStats arena = FrameArenaGetStats();
+        DrawUIText(customFont, TextFormat("Frame Arena: %.1f KB (peak %.1f KB, %.0f KB held)", arena.used / 1024.0f, arena.peak / 1024.0f, arena.reserved / 1024.0f), stats_x, 192 * cfg->ui_scale, 14 * cfg->ui_scale, cfg->text_secondary);
     }
 
     bool show_real_time = (*ctx->time_multiplier == 1.0 && fabs(*ctx->current_epoch - get_current_real_time_epoch()) < (5.0 / 86400.0) && !*ctx->is_auto_warping);
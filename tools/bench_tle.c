@@ -0,0 +1,166 @@
+#define _GNU_SOURCE
+/* TLE parser benchmark, built with `make bench-tle` against the app's astro.o */
+#include "astro.h"
+#include "astro_internal.h"
+#include <math.h>
+#include <string.h>
+#include <time.h>
+
+/* string extraction the old path used (sscanf is a bit too beefy for tight TLE loops) */
+static double parse_tle_double(const char *str, int start, int len)
+{
+    char buf[32] = {0};
+    strncpy(buf, str + start, len);
+    return atof(buf);
+}
+
+static double bench_clock_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+/* the pre-parse_tle_record() path, only kept around to race against */
+static bool legacy_parse_tle(const char *line0, const char *line1, const char *line2, Satellite *sat)
+{
+    char combined[768];
+    snprintf(combined, sizeof(combined), "%s\n%s\n%s\n", line0, line1, line2);
+
+    struct TLEObject *parsed_objs = NULL;
+    int num_objs = 0;
+    ParseFileOrString(NULL, combined, &parsed_objs, &num_objs);
+    if (num_objs <= 0 || parsed_objs == NULL)
+    {
+        free(parsed_objs);
+        return false;
+    }
+    double initial_r[3] = {0};
+    double initial_v[3] = {0};
+    ConvertTLEToSGP4(&sat->satrec, &parsed_objs[0], 0.0, initial_r, initial_v);
+    free(parsed_objs);
+
+    double raw_epoch = parse_tle_double(line1, 18, 14);
+    int yy = (int)(raw_epoch / 1000.0);
+    int year = (yy < 57) ? 2000 + yy : 1900 + yy;
+    sat->epoch_days = (year * 1000.0) + fmod(raw_epoch, 1000.0);
+    sat->epoch_unix = get_unix_from_epoch(sat->epoch_days);
+    sat->inclination = parse_tle_double(line2, 8, 8) * DEG2RAD;
+    sat->raan = parse_tle_double(line2, 17, 8) * DEG2RAD;
+    char ecc_buf[32] = "0.";
+    strncpy(ecc_buf + 2, line2 + 26, 7);
+    sat->eccentricity = atof(ecc_buf);
+    sat->arg_perigee = parse_tle_double(line2, 34, 8) * DEG2RAD;
+    sat->mean_anomaly = parse_tle_double(line2, 43, 8) * DEG2RAD;
+    double revs_per_day = parse_tle_double(line2, 52, 11);
+    sat->mean_motion = (revs_per_day * 2.0 * PI) / 86400.0;
+    sat->semi_major_axis = pow(MU / (sat->mean_motion * sat->mean_motion), 1.0 / 3.0);
+    return true;
+}
+
+/* times the old snprintf -> ParseFileOrString -> rescrape path against parse_tle_record() on every record of a TLE file,
+   with and without sgp4init, and checks both end up with the same elements */
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: bench_tle FILE [ROUNDS]\n");
+        return 1;
+    }
+    const char *filename = argv[1];
+    int rounds = argc > 2 ? atoi(argv[2]) : 10;
+    if (rounds < 1)
+        rounds = 1;
+
+    FILE *file = fopen(filename, "r");
+    if (!file)
+    {
+        fprintf(stderr, "Failed to open %s\n", filename);
+        return 1;
+    }
+
+    char (*lines)[3][256] = NULL;
+    int count = 0, cap = 0;
+    char line0[256];
+    while (fgets(line0, sizeof(line0), file))
+    {
+        if (line0[0] == '#' || line0[0] == '\n' || line0[0] == '\r')
+            continue;
+        if (count == cap)
+        {
+            int grown_cap = cap ? cap * 2 : 1024;
+            char (*grown)[3][256] = realloc(lines, sizeof(*lines) * grown_cap);
+            if (!grown)
+            {
+                fprintf(stderr, "Out of memory after %d records\n", count);
+                break;
+            }
+            lines = grown;
+            cap = grown_cap;
+        }
+        strcpy(lines[count][0], line0);
+        if (!fgets(lines[count][1], 256, file) || !fgets(lines[count][2], 256, file))
+            break;
+        for (int k = 0; k < 3; k++)
+            lines[count][k][strcspn(lines[count][k], "\r\n")] = 0;
+        count++;
+    }
+    fclose(file);
+    if (count == 0)
+    {
+        fprintf(stderr, "No TLE records in %s\n", filename);
+        free(lines);
+        return 1;
+    }
+
+    Satellite *a = calloc(1, sizeof(Satellite)), *b = calloc(1, sizeof(Satellite));
+    struct TLEObject obj;
+    int legacy_ok = 0, fast_ok = 0, mismatches = 0;
+    double initial_r[3], initial_v[3];
+
+    /* parse only: the old path can't skip sgp4init, so it gets timed with it and the init cost is taken off below */
+    double t0 = bench_clock_ms();
+    for (int r = 0; r < rounds; r++)
+        for (int i = 0; i < count; i++)
+            legacy_ok += legacy_parse_tle(lines[i][0], lines[i][1], lines[i][2], a);
+    double legacy_ms = bench_clock_ms() - t0;
+
+    t0 = bench_clock_ms();
+    for (int r = 0; r < rounds; r++)
+        for (int i = 0; i < count; i++)
+            fast_ok += parse_tle_record(lines[i][0], strlen(lines[i][0]), lines[i][1], strlen(lines[i][1]), lines[i][2], strlen(lines[i][2]), b, &obj) == NULL;
+    double fast_parse_ms = bench_clock_ms() - t0;
+
+    t0 = bench_clock_ms();
+    for (int r = 0; r < rounds; r++)
+        for (int i = 0; i < count; i++)
+            if (!parse_tle_record(lines[i][0], strlen(lines[i][0]), lines[i][1], strlen(lines[i][1]), lines[i][2], strlen(lines[i][2]), b, &obj))
+                ConvertTLEToSGP4(&b->satrec, &obj, 0.0, initial_r, initial_v);
+    double fast_ms = bench_clock_ms() - t0;
+
+    for (int i = 0; i < count; i++)
+    {
+        bool la = legacy_parse_tle(lines[i][0], lines[i][1], lines[i][2], a);
+        bool fb = !parse_tle_record(lines[i][0], strlen(lines[i][0]), lines[i][1], strlen(lines[i][1]), lines[i][2], strlen(lines[i][2]), b, &obj);
+        if (!la || !fb)
+            continue;
+        ConvertTLEToSGP4(&b->satrec, &obj, 0.0, initial_r, initial_v);
+        if (a->epoch_unix != b->epoch_unix || a->inclination != b->inclination || a->eccentricity != b->eccentricity || a->mean_motion != b->mean_motion ||
+            memcmp(&a->satrec, &b->satrec, sizeof(a->satrec)) != 0)
+            mismatches++;
+    }
+
+    double n = (double)count * rounds;
+    double init_ns = (fast_ms - fast_parse_ms) * 1e6 / n;
+    printf("%d records x %d rounds from %s\n", count, rounds, filename);
+    printf("  current path    %8.1f ns/record (%.1f ns without sgp4init), %d accepted\n", legacy_ms * 1e6 / n, legacy_ms * 1e6 / n - init_ns,
+           legacy_ok / rounds);
+    printf("  fixed column    %8.1f ns/record (%.1f ns without sgp4init), %d accepted\n", fast_ms * 1e6 / n, fast_parse_ms * 1e6 / n, fast_ok / rounds);
+    printf("  speedup         %8.2fx overall, %.2fx parsing\n", legacy_ms / fast_ms, (legacy_ms * 1e6 / n - init_ns) / (fast_parse_ms * 1e6 / n));
+    printf("  mismatches      %8d\n", mismatches);
+
+    free(a);
+    free(b);
+    free(lines);
+    return 0;
+}